@@ -54,11 +54,15 @@ int main() {
     int total_steps = static_cast<int>(t / dt);
     int plot_interval = total_steps / 5;
 
+    // Scratch buffers of the fused update, allocated on the first step
+    Workspace ws;
+    VecExpr u = lazy(U);
+
     for (int step = 0; step <= total_steps; ++step) {
         double time = step * dt;
 
         // Explicit update
-        U += (-dt / 2.0) * (D * (I * arma::square(U)));
+        evaluate(u + (-dt / 2.0) * (D * (I * square(u))), U, ws);
 
         if (step % plot_interval == 0) {
             double area = Utils::trapz(xgrid, U);
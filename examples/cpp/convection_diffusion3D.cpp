@@ -138,6 +138,11 @@ int main() {
     sp_mat L = dt * D * Kdiag * G + I_sp;
     sp_mat Dadv = dt * D * Vdiag * I;
 
+    // Row-parallel copies for the time loop
+    CSRMatrix L_csr(L);
+    CSRMatrix Dadv_csr(Dadv);
+    vec Cnew, Cadv;
+
     #if OUTPUT_FRAME_DATA
     // Open a single file to store selected frames
     std::ofstream frameFile("frames.txt");
@@ -150,14 +155,14 @@ int main() {
     // Time-stepping loop
     for (int i_ = 1; i_ <= iters*3; ++i_) {
         // Diffusion step
-        vec Cnew = L * C;
+        L_csr.apply(C, Cnew);
         for (auto w : wellIndices) {
             Cnew(w) = 1.0;
         }
         C = Cnew;
 
         // Advection step
-        vec Cadv = Dadv * C;
+        Dadv_csr.apply(C, Cadv);
         Cadv = C - Cadv;
         for (auto w : wellIndices) {
             Cadv(w) = 1.0;
@@ -15,8 +15,7 @@ int main() {
 
   // Get mimetic operators
   Laplacian L(k, m, n, 1, 1);
-  RobinBC BC(k, m, 1, n, 1, 1, 0); // Dirichlet BC
-  L = L + BC;
+  BoundaryPatch::robin(k, m, 1, n, 1, 1, 0).add_to(L); // Dirichlet BC
 
   // Build RHS for system of equations
   mat rhs(m + 2, n + 2, fill::zeros);
@@ -48,8 +48,9 @@ int main() {
 
   // Get mimetic operators
   Laplacian L(k, m, n, p, dx, dy, dz);
-  RobinBC BC(k, m, dx, n, dy, p, dz, DIRICHLET_COEF, NEUMANN_COEF);  // Dirichlet BC
-  L = L + BC;
+  // Dirichlet BC, written into the boundary rows of L
+  BoundaryPatch::robin(k, m, dx, n, dy, p, dz, DIRICHLET_COEF, NEUMANN_COEF)
+      .add_to(L);
 
   // Build RHS for system of equations
   arma::cube rhs(m + 2, n + 2, p + 2, arma::fill::zeros);
@@ -102,6 +102,9 @@ int main() {
   RobinBC BC(k, m, dx, n, dy, 0, 1);  // Neumann BC
   L = L + BC;
 
+  // L does not change between time steps, so factorize it only once
+  SparseSolver solver(L);
+
   // Pre-multiply the gradient operator for pressure correction.
   G *= (-dt / rho_middle);
 
@@ -171,12 +174,7 @@ int main() {
 
     // Solve the pressure Poisson equation
     vec p_vec;
-#ifdef EIGEN
-    p_vec = Utils::spsolve_eigen(L, b);
-#else
-    // Default to SuperLU if EIGEN is not defined
-    p_vec = spsolve(L, b);
-#endif
+    p_vec = solver.solve(b);
 
     // Reshape the solution vector back into a matrix
     p = reshape(p_vec, m + 2, n + 2).t();
@@ -25,7 +25,7 @@ int main() {
   V.diag(0) = grid;
 
   // Hamiltonian
-  sp_mat H = -0.5 * (sp_mat)L + V;
+  sp_mat H = -0.5 * L + V;
 
   cx_vec eigval;
   eig_gen(eigval, (mat)H); // Compute eigenvalues
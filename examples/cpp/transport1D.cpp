@@ -41,11 +41,16 @@ int main() {
   // dt = dt/R (retardation)
   dt /= R;
 
+  // Scratch buffers of the fused update, allocated on the first step
+  Workspace ws;
+  VecExpr c = lazy(C);
+  VecExpr v = lazy(V);
+
   // Time integration loop
   for (int i = 0; i <= iter; i++) {
 
     // First-order forward-time scheme
-    C += dt * (D * (dis * (G * C)) - D * (V % (I * C)));
+    evaluate(c + dt * (D * (dis * (G * c)) - D * (v % (I * c))), C, ws);
 
     // Right boundary condition (reflection)
     C(m + 1) = C(m);
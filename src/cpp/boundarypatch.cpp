@@ -0,0 +1,223 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file boundarypatch.cpp
+ *
+ * @brief Boundary rows of a multi-dimensional boundary condition
+ *
+ * @date 2024/10/15
+ */
+
+#include "boundarypatch.h"
+#include "robinbc.h"
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+BoundaryPatch::BoundaryPatch(const sp_mat &Bm) : dims(0) {
+  add_axis(Bm);
+  n_rows = size[0];
+}
+
+BoundaryPatch::BoundaryPatch(const sp_mat &Bm, const sp_mat &Bn) : dims(0) {
+  add_axis(Bm);
+  add_axis(Bn);
+  n_rows = size[0] * size[1];
+}
+
+BoundaryPatch::BoundaryPatch(const sp_mat &Bm, const sp_mat &Bn,
+                             const sp_mat &Bo)
+    : dims(0) {
+  add_axis(Bm);
+  add_axis(Bn);
+  add_axis(Bo);
+  n_rows = size[0] * size[1] * size[2];
+}
+
+BoundaryPatch BoundaryPatch::robin(u16 k, u32 m, Real dx, Real a, Real b) {
+  return BoundaryPatch(RobinBC(k, m, dx, a, b));
+}
+
+BoundaryPatch BoundaryPatch::robin(u16 k, u32 m, Real dx, u32 n, Real dy,
+                                   Real a, Real b) {
+  return BoundaryPatch(RobinBC(k, m, dx, a, b), RobinBC(k, n, dy, a, b));
+}
+
+BoundaryPatch BoundaryPatch::robin(u16 k, u32 m, Real dx, u32 n, Real dy,
+                                   u32 o, Real dz, Real a, Real b) {
+  return BoundaryPatch(RobinBC(k, m, dx, a, b), RobinBC(k, n, dy, a, b),
+                       RobinBC(k, o, dz, a, b));
+}
+
+void BoundaryPatch::add_axis(const sp_mat &B) {
+  assert(B.n_rows == B.n_cols && B.n_rows >= 3);
+
+  const uword last = B.n_rows - 1;
+  size[dims] = B.n_rows;
+  for (uword d = dims + 1; d < 3; ++d)
+    size[d] = 1;
+
+  Row &lo = low[dims];
+  Row &hi = high[dims];
+
+  B.sync();
+  for (uword j = 0; j < B.n_cols; ++j) {
+    for (uword p = B.col_ptrs[j]; p < B.col_ptrs[j + 1]; ++p) {
+      const uword r = B.row_indices[p];
+      if (r != 0 && r != last)
+        throw std::invalid_argument(
+            "Boundary operator has entries outside its boundary rows");
+      Row &s = r == 0 ? lo : hi;
+      s.cols.push_back(j);
+      s.values.push_back(B.values[p]);
+    }
+  }
+
+  ++dims;
+}
+
+template <typename F> void BoundaryPatch::for_each(F f) const {
+  const uword st[3] = {1, size[0], size[0] * size[1]};
+
+  for (u32 d = 0; d < dims; ++d) {
+    // Rows of axis d: all nodes of the previous axes, interior nodes of the
+    // following ones
+    uword lo[3], hi[3], step[3];
+    for (u32 e = 0; e < 3; ++e) {
+      const bool full = e < d || e >= dims;
+      lo[e] = full ? 0 : 1;
+      hi[e] = full ? size[e] : size[e] - 1;
+      step[e] = 1;
+    }
+    lo[d] = 0;
+    hi[d] = size[d];
+    step[d] = size[d] - 1;
+
+    for (uword i2 = lo[2]; i2 < hi[2]; i2 += step[2]) {
+      for (uword i1 = lo[1]; i1 < hi[1]; i1 += step[1]) {
+        for (uword i0 = lo[0]; i0 < hi[0]; i0 += step[0]) {
+          const uword i[3] = {i0, i1, i2};
+          const uword row = i0 * st[0] + i1 * st[1] + i2 * st[2];
+          const uword base = row - i[d] * st[d];
+          const Row &s = i[d] == 0 ? low[d] : high[d];
+
+          for (size_t t = 0; t < s.cols.size(); ++t)
+            f(row, base + s.cols[t] * st[d], s.values[t]);
+        }
+      }
+    }
+  }
+}
+
+void BoundaryPatch::add_to(sp_mat &A) const {
+  if (A.n_rows != n_rows || A.n_cols != n_rows)
+    throw std::invalid_argument(
+        "BoundaryPatch does not match the size of the operator");
+
+  struct Entry {
+    uword col, row;
+    Real value;
+  };
+
+  // Patch entries by column, then row, with corner duplicates summed
+  std::vector<Entry> e;
+  e.reserve(entries());
+  for_each([&e](uword r, uword c, Real v) { e.push_back({c, r, v}); });
+  std::sort(e.begin(), e.end(), [](const Entry &x, const Entry &y) {
+    return x.col < y.col || (x.col == y.col && x.row < y.row);
+  });
+
+  size_t u = 0;
+  for (size_t t = 0; t < e.size(); ++t) {
+    if (u > 0 && e[u - 1].col == e[t].col && e[u - 1].row == e[t].row)
+      e[u - 1].value += e[t].value;
+    else
+      e[u++] = e[t];
+  }
+  e.resize(u);
+
+  // Entries not yet in the pattern of A
+  A.sync();
+  uword added = 0;
+  for (const Entry &x : e)
+    if (!std::binary_search(A.row_indices + A.col_ptrs[x.col],
+                            A.row_indices + A.col_ptrs[x.col + 1], x.row))
+      ++added;
+
+  // Keeps the existing entries in front, and drops the element cache
+  const uword old_nnz = A.n_nonzero;
+  A.mem_resize(old_nnz + added);
+
+  uword *col_ptrs = access::rwp(A.col_ptrs);
+  uword *row_indices = access::rwp(A.row_indices);
+  Real *values = access::rwp(A.values);
+
+  // Merges from the last column backwards: the write position never falls
+  // behind the read position, so entries are moved before they are
+  // overwritten
+  uword w = old_nnz + added;
+  uword old_end = old_nnz;
+  size_t q = e.size();
+  for (uword j = A.n_cols; j-- > 0;) {
+    const uword old_begin = col_ptrs[j];
+    uword p = old_end;
+    col_ptrs[j + 1] = w;
+
+    while (p > old_begin || (q > 0 && e[q - 1].col == j)) {
+      const bool patch = q > 0 && e[q - 1].col == j;
+      --w;
+      if (p > old_begin && (!patch || row_indices[p - 1] > e[q - 1].row)) {
+        --p;
+        row_indices[w] = row_indices[p];
+        values[w] = values[p];
+      } else if (p == old_begin || e[q - 1].row > row_indices[p - 1]) {
+        --q;
+        row_indices[w] = e[q].row;
+        values[w] = e[q].value;
+      } else {
+        --p;
+        --q;
+        row_indices[w] = row_indices[p];
+        values[w] = values[p] + e[q].value;
+      }
+    }
+
+    old_end = old_begin;
+  }
+
+  assert(w == 0 && q == 0);
+}
+
+sp_mat BoundaryPatch::assemble() const {
+  Triplets t(n_rows, n_rows, entries());
+  for_each([&t](uword r, uword c, Real v) { t.at(r, c) = v; });
+  return t.assemble();
+}
+
+uword BoundaryPatch::rows() const {
+  uword total = 0;
+  for (u32 d = 0; d < dims; ++d) {
+    uword count = 2;
+    for (u32 e = 0; e < dims; ++e)
+      if (e != d)
+        count *= e < d ? size[e] : size[e] - 2;
+    total += count;
+  }
+  return total;
+}
+
+uword BoundaryPatch::entries() const {
+  uword total = 0;
+  for (u32 d = 0; d < dims; ++d) {
+    uword faces = 1;
+    for (u32 e = 0; e < dims; ++e)
+      if (e != d)
+        faces *= e < d ? size[e] : size[e] - 2;
+    total += faces * (low[d].cols.size() + high[d].cols.size());
+  }
+  return total;
+}
@@ -0,0 +1,134 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file boundarypatch.h
+ *
+ * @brief Boundary rows of a multi-dimensional boundary condition
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef BOUNDARYPATCH_H
+#define BOUNDARYPATCH_H
+
+#include "utils.h"
+#include <vector>
+
+/**
+ * @brief Compact form of RobinBC / MixedBC, boundary rows only
+ *
+ * A boundary operator on an (m+2) x (n+2) x (o+2) grid is nonzero only in
+ * the rows of boundary nodes, and each of those rows is the first or last
+ * row of a 1-D boundary operator laid along one axis. The patch keeps those
+ * 1-D stencils, O(k) values per face, and enumerates the boundary rows on
+ * the fly with the same coverage as the 2-D/3-D RobinBC constructors: rows
+ * of axis d span every node of the previous axes and the interior nodes of
+ * the following ones.
+ *
+ * add_to() merges the patch into an existing operator, so
+ *
+ * @code
+ * Laplacian L(k, m, n, o, dx, dy, dz);
+ * BoundaryPatch::robin(k, m, dx, n, dy, o, dz, a, b).add_to(L);
+ * @endcode
+ *
+ * gives the same matrix as L = L + RobinBC(...), but inserts the boundary
+ * entries into L's own storage instead of assembling the boundary operator
+ * and the sum as two more matrices.
+ */
+class BoundaryPatch {
+
+public:
+  /**
+   * @brief 1-D patch
+   *
+   * @param Bm 1-D boundary operator, e.g. RobinBC or MixedBC, nonzero only in
+   * its first and last rows
+   */
+  explicit BoundaryPatch(const sp_mat &Bm);
+
+  /**
+   * @brief 2-D patch from the 1-D boundary operators of each axis
+   *
+   * @param Bm Boundary operator along x
+   * @param Bn Boundary operator along y
+   */
+  BoundaryPatch(const sp_mat &Bm, const sp_mat &Bn);
+
+  /**
+   * @brief 3-D patch from the 1-D boundary operators of each axis
+   *
+   * @param Bm Boundary operator along x
+   * @param Bn Boundary operator along y
+   * @param Bo Boundary operator along z
+   */
+  BoundaryPatch(const sp_mat &Bm, const sp_mat &Bn, const sp_mat &Bo);
+
+  /**
+   * @brief Patch of RobinBC(k, m, dx, a, b)
+   */
+  static BoundaryPatch robin(u16 k, u32 m, Real dx, Real a, Real b);
+
+  /**
+   * @brief Patch of RobinBC(k, m, dx, n, dy, a, b)
+   */
+  static BoundaryPatch robin(u16 k, u32 m, Real dx, u32 n, Real dy, Real a,
+                             Real b);
+
+  /**
+   * @brief Patch of RobinBC(k, m, dx, n, dy, o, dz, a, b)
+   */
+  static BoundaryPatch robin(u16 k, u32 m, Real dx, u32 n, Real dy, u32 o,
+                             Real dz, Real a, Real b);
+
+  /**
+   * @brief A += patch, merged into the storage of A in place
+   *
+   * Entries that already exist in A are summed. The others are counted,
+   * A's CSC arrays are grown once by that count, and the columns are merged
+   * from the back so that no entry is overwritten before it is moved. Only
+   * the patch entries, O(k) per boundary row, are held on the side.
+   *
+   * @param A Operator of the same size, e.g. a Laplacian
+   */
+  void add_to(sp_mat &A) const;
+
+  /**
+   * @brief Full-size boundary operator, equal to the RobinBC / MixedBC matrix
+   */
+  sp_mat assemble() const;
+
+  /**
+   * @brief Number of boundary rows, corners counted once per axis
+   */
+  uword rows() const;
+
+  /**
+   * @brief Number of entries the patch adds
+   */
+  uword entries() const;
+
+  uword n_rows;
+
+private:
+  // Nonzeros of a boundary row of a 1-D operator, (column, value)
+  struct Row {
+    std::vector<uword> cols;
+    std::vector<Real> values;
+  };
+
+  void add_axis(const sp_mat &B);
+
+  template <typename F> void for_each(F f) const;
+
+  u32 dims;
+  uword size[3];     // Grid points per axis, boundary nodes included
+  Row low[3];        // First row of the 1-D operator of each axis
+  Row high[3];       // Last row
+};
+
+#endif // BOUNDARYPATCH_H
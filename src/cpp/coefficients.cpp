@@ -0,0 +1,22 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file coefficients.cpp
+ *
+ * @brief Compile-time coefficient tables of the mimetic operators
+ *
+ * @date 2024/10/15
+ */
+
+#include "coefficients.h"
+
+// Storage for the tables when they are used at run time (C++14)
+constexpr Real Coefficients::gradient_boundary[4][4][9];
+constexpr Real Coefficients::divergence_boundary[3][2][7];
+constexpr Real Coefficients::interior_stencil[4][8];
+constexpr Real Coefficients::gradient_weights[4][17];
+constexpr Real Coefficients::divergence_weights[3][13];
@@ -0,0 +1,164 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file coefficients.h
+ *
+ * @brief Compile-time coefficient tables of the mimetic operators
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef COEFFICIENTS_H
+#define COEFFICIENTS_H
+
+#include "utils.h"
+
+/**
+ * @brief Unscaled coefficients of the mimetic operators, per order k
+ *
+ * Tables are indexed by k / 2 - 1 for k = 2, 4, 6, 8 (k = 2, 4, 6 for the
+ * divergence) and divided by the grid spacing by their users. Only the
+ * boundary block at the left end is stored; the block at the right end is
+ * its mirror image with opposite sign:
+ *
+ *   G(m - i, m + 1 - j) = -G(i, j)
+ *   D(m + 1 - i, m - j) = -D(i, j)
+ */
+struct Coefficients {
+  /**
+   * @brief Boundary rows 0 .. k/2 - 1 of the gradient, k + 1 entries each
+   */
+  static constexpr Real gradient_boundary[4][4][9] = {
+      {{-8.0 / 3.0, 3.0, -1.0 / 3.0}},
+      {{-352.0 / 105.0, 35.0 / 8.0, -35.0 / 24.0, 21.0 / 40.0, -5.0 / 56.0},
+       {16.0 / 105.0, -31.0 / 24.0, 29.0 / 24.0, -3.0 / 40.0, 1.0 / 168.0}},
+      {{-13016.0 / 3465.0, 693.0 / 128.0, -385.0 / 128.0, 693.0 / 320.0,
+        -495.0 / 448.0, 385.0 / 1152.0, -63.0 / 1408.0},
+       {496.0 / 3465.0, -811.0 / 640.0, 449.0 / 384.0, -29.0 / 960.0,
+        -11.0 / 448.0, 13.0 / 1152.0, -37.0 / 21120.0},
+       {-8.0 / 385.0, 179.0 / 1920.0, -153.0 / 128.0, 381.0 / 320.0,
+        -101.0 / 1344.0, 1.0 / 128.0, -3.0 / 7040.0}},
+      {{-4856215.0 / 1200963.0, 45858154.0 / 7297397.0,
+        -23409299.0 / 4789435.0, 3799178.0 / 719717.0,
+        -4892189.0 / 1089890.0, 1789111.0 / 658879.0,
+        -1406819.0 / 1289899.0, 1154863.0 / 4436807.0,
+        -2936602.0 / 105142673.0},
+       {86048.0 / 675675.0, -131093.0 / 107520.0, 5503131.0 / 5166017.0,
+        305249.0 / 2136437.0, -1763845.0 / 8250973.0, 1562032.0 / 10745723.0,
+        -270419.0 / 4422611.0, 2983.0 / 199680.0, -2621.0 / 1612800.0},
+       {-3776.0 / 225225.0, 8707.0 / 107520.0, -17947.0 / 15360.0,
+        29319.0 / 25600.0, -533.0 / 21504.0, -263.0 / 9216.0,
+        903.0 / 56320.0, -283.0 / 66560.0, 257.0 / 537600.0},
+       {32.0 / 9009.0, -543.0 / 35840.0, 265.0 / 3072.0, -1233.0 / 1024.0,
+        8625.0 / 7168.0, -775.0 / 9216.0, 639.0 / 56320.0, -15.0 / 13312.0,
+        1.0 / 21504.0}}};
+
+  /**
+   * @brief Boundary rows 1 .. k/2 - 1 of the divergence, k + 1 entries each
+   *
+   * Rows 0 and m + 1 of the divergence are zero, and k = 2 has no boundary
+   * rows.
+   */
+  static constexpr Real divergence_boundary[3][2][7] = {
+      {},
+      {{-11.0 / 12.0, 17.0 / 24.0, 3.0 / 8.0, -5.0 / 24.0, 1.0 / 24.0}},
+      {{-1627.0 / 1920.0, 211.0 / 640.0, 59.0 / 48.0, -235.0 / 192.0,
+        91.0 / 128.0, -443.0 / 1920.0, 31.0 / 960.0},
+       {31.0 / 960.0, -687.0 / 640.0, 129.0 / 128.0, 19.0 / 192.0,
+        -3.0 / 32.0, 21.0 / 640.0, -3.0 / 640.0}}};
+
+  /**
+   * @brief Interior stencil shared by the gradient and divergence, k entries
+   */
+  static constexpr Real interior_stencil[4][8] = {
+      {-1.0, 1.0},
+      {1.0 / 24.0, -9.0 / 8.0, 9.0 / 8.0, -1.0 / 24.0},
+      {-3.0 / 640.0, 25.0 / 384.0, -75.0 / 64.0, 75.0 / 64.0, -25.0 / 384.0,
+       3.0 / 640.0},
+      {5.0 / 7168.0, -49.0 / 5120.0, 245.0 / 3072.0, -1225.0 / 1024.0,
+       1225.0 / 1024.0, -245.0 / 3072.0, 49.0 / 5120.0, -5.0 / 7168.0}};
+
+  /**
+   * @brief Weights P of the gradient, 2k + 1 entries
+   */
+  static constexpr Real gradient_weights[4][17] = {
+      {3.0 / 8.0, 9.0 / 8.0, 1.0, 9.0 / 8.0, 3.0 / 8.0},
+      {1606.0 / 4535.0, 941.0 / 766.0, 1384.0 / 1541.0, 1371.0 / 1346.0,
+       701.0 / 700.0, 1371.0 / 1346.0, 1384.0 / 1541.0, 941.0 / 766.0,
+       1606.0 / 4535.0},
+      {420249.0 / 1331069.0, 2590978.0 / 1863105.0, 882762.0 / 1402249.0,
+       1677712.0 / 1359311.0, 239985.0 / 261097.0, 664189.0 / 657734.0,
+       756049.0 / 754729.0, 664189.0 / 657734.0, 239985.0 / 261097.0,
+       1677712.0 / 1359311.0, 882762.0 / 1402249.0, 2590978.0 / 1863105.0,
+       420249.0 / 1331069.0},
+      {267425.0 / 904736.0, 2307435.0 / 1517812.0, 847667.0 / 3066027.0,
+       4050911.0 / 2301238.0, 498943.0 / 1084999.0, 211042.0 / 170117.0,
+       2065895.0 / 2191686.0, 1262499.0 / 1258052.0, 1314891.0 / 1312727.0,
+       1262499.0 / 1258052.0, 2065895.0 / 2191686.0, 211042.0 / 170117.0,
+       498943.0 / 1084999.0, 4050911.0 / 2301238.0, 847667.0 / 3066027.0,
+       2307435.0 / 1517812.0, 267425.0 / 904736.0}};
+
+  /**
+   * @brief Weights Q of the divergence, 2k + 1 entries
+   */
+  static constexpr Real divergence_weights[3][13] = {
+      {1.0, 1.0, 1.0, 1.0, 1.0},
+      {2186.0 / 1943.0, 2125.0 / 2828.0, 1441.0 / 1240.0, 648.0 / 673.0,
+       349.0 / 350.0, 648.0 / 673.0, 1441.0 / 1240.0, 2125.0 / 2828.0,
+       2186.0 / 1943.0},
+      {2383.0 / 2005.0, 929.0 / 2002.0, 887.0 / 531.0, 3124.0 / 5901.0,
+       1706.0 / 1457.0, 457.0 / 467.0, 1057.0 / 1061.0, 457.0 / 467.0,
+       1706.0 / 1457.0, 3124.0 / 5901.0, 887.0 / 531.0, 929.0 / 2002.0,
+       2383.0 / 2005.0}};
+
+  /**
+   * @brief Number of boundary rows of the gradient at each end
+   */
+  static constexpr u16 gradient_rows(u16 k) { return k / 2; }
+
+  /**
+   * @brief Number of nonzero boundary rows of the divergence at each end
+   */
+  static constexpr u16 divergence_rows(u16 k) { return k / 2 - 1; }
+
+  /**
+   * @brief Row i of the gradient, k + 1 entries starting at column 0
+   */
+  static constexpr const Real *gradient_row(u16 k, u16 i = 0) {
+    return gradient_boundary[k / 2 - 1][i];
+  }
+
+  /**
+   * @brief Row i + 1 of the divergence, k + 1 entries starting at column 0
+   */
+  static constexpr const Real *divergence_row(u16 k, u16 i) {
+    return divergence_boundary[k / 2 - 1][i];
+  }
+
+  /**
+   * @brief interior_stencil of order k
+   */
+  static constexpr const Real *interior(u16 k) {
+    return interior_stencil[k / 2 - 1];
+  }
+
+  /**
+   * @brief gradient_weights of order k
+   */
+  static constexpr const Real *gradient_P(u16 k) {
+    return gradient_weights[k / 2 - 1];
+  }
+
+  /**
+   * @brief divergence_weights of order k
+   */
+  static constexpr const Real *divergence_Q(u16 k) {
+    return divergence_weights[k / 2 - 1];
+  }
+};
+
+#endif // COEFFICIENTS_H
@@ -0,0 +1,55 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file complexoperators.cpp
+ *
+ * @brief Complex-valued mimetic operators
+ *
+ * @date 2024/10/15
+ */
+
+#include "complexoperators.h"
+#include "laplacian.h"
+#include "robinbc.h"
+
+// a * D + b * G from the Dirichlet part D and the Neumann part G
+static cx_sp_mat combine(const sp_mat &D, const sp_mat &G, cx_double a,
+                         cx_double b) {
+  return cx_sp_mat(a.real() * D + b.real() * G, a.imag() * D + b.imag() * G);
+}
+
+cxLaplacian::cxLaplacian(u16 k, u32 m, Real dx) {
+  const Laplacian L(k, m, dx);
+  *this = cx_sp_mat(L, sp_mat(L.n_rows, L.n_cols));
+}
+
+cxLaplacian::cxLaplacian(u16 k, u32 m, u32 n, Real dx, Real dy) {
+  const Laplacian L(k, m, n, dx, dy);
+  *this = cx_sp_mat(L, sp_mat(L.n_rows, L.n_cols));
+}
+
+cxLaplacian::cxLaplacian(u16 k, u32 m, u32 n, u32 o, Real dx, Real dy,
+                         Real dz) {
+  const Laplacian L(k, m, n, o, dx, dy, dz);
+  *this = cx_sp_mat(L, sp_mat(L.n_rows, L.n_cols));
+}
+
+cxRobinBC::cxRobinBC(u16 k, u32 m, Real dx, cx_double a, cx_double b) {
+  *this = combine(RobinBC(k, m, dx, 1, 0), RobinBC(k, m, dx, 0, 1), a, b);
+}
+
+cxRobinBC::cxRobinBC(u16 k, u32 m, Real dx, u32 n, Real dy, cx_double a,
+                     cx_double b) {
+  *this = combine(RobinBC(k, m, dx, n, dy, 1, 0),
+                  RobinBC(k, m, dx, n, dy, 0, 1), a, b);
+}
+
+cxRobinBC::cxRobinBC(u16 k, u32 m, Real dx, u32 n, Real dy, u32 o, Real dz,
+                     cx_double a, cx_double b) {
+  *this = combine(RobinBC(k, m, dx, n, dy, o, dz, 1, 0),
+                  RobinBC(k, m, dx, n, dy, o, dz, 0, 1), a, b);
+}
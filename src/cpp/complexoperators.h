@@ -0,0 +1,85 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file complexoperators.h
+ *
+ * @brief Complex-valued mimetic operators
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef COMPLEXOPERATORS_H
+#define COMPLEXOPERATORS_H
+
+#include "utils.h"
+
+/**
+ * @brief Mimetic Laplacian stored as a complex matrix
+ *
+ * Same entries as Laplacian, so it applies to a complex wavefunction in one
+ * product instead of one per real and imaginary part.
+ */
+class cxLaplacian : public cx_sp_mat {
+
+public:
+  using cx_sp_mat::operator=;
+
+  /**
+   * @brief 1-D Constructor
+   *
+   * @param k Order of accuracy
+   * @param m Number of cells
+   * @param dx Spacing between cells
+   */
+  cxLaplacian(u16 k, u32 m, Real dx);
+
+  /**
+   * @brief 2-D Constructor
+   */
+  cxLaplacian(u16 k, u32 m, u32 n, Real dx, Real dy);
+
+  /**
+   * @brief 3-D Constructor
+   */
+  cxLaplacian(u16 k, u32 m, u32 n, u32 o, Real dx, Real dy, Real dz);
+};
+
+/**
+ * @brief Robin boundary operator a * u + b * du/dn with complex coefficients
+ *
+ * Covers absorbing and transparent boundaries of wave and Schrodinger
+ * problems, e.g. du/dn = i * kappa * u with a = -i * kappa and b = 1.
+ */
+class cxRobinBC : public cx_sp_mat {
+
+public:
+  using cx_sp_mat::operator=;
+
+  /**
+   * @brief 1-D Constructor
+   *
+   * @param k Order of accuracy
+   * @param m Number of cells
+   * @param dx Spacing between cells
+   * @param a Coefficient of the Dirichlet function
+   * @param b Coefficient of the Neumann function
+   */
+  cxRobinBC(u16 k, u32 m, Real dx, cx_double a, cx_double b);
+
+  /**
+   * @brief 2-D Constructor
+   */
+  cxRobinBC(u16 k, u32 m, Real dx, u32 n, Real dy, cx_double a, cx_double b);
+
+  /**
+   * @brief 3-D Constructor
+   */
+  cxRobinBC(u16 k, u32 m, Real dx, u32 n, Real dy, u32 o, Real dz,
+            cx_double a, cx_double b);
+};
+
+#endif // COMPLEXOPERATORS_H
@@ -0,0 +1,82 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file csrmatrix.cpp
+ *
+ * @brief Row-compressed copy of an operator for parallel products
+ *
+ * @date 2024/10/15
+ */
+
+#include "csrmatrix.h"
+#include <algorithm>
+#include <cassert>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+template <typename eT>
+CSRMatrixT<eT>::CSRMatrixT(const sp_mat &A)
+    : n_rows(A.n_rows), n_cols(A.n_cols) {
+  // The columns of A^T are the rows of A
+  sp_mat At = A.t();
+  At.sync();
+  n_nonzero = At.n_nonzero;
+
+  row_ptr.assign(At.col_ptrs, At.col_ptrs + At.n_cols + 1);
+  col_ind.assign(At.row_indices, At.row_indices + At.n_nonzero);
+  val.assign(At.values, At.values + At.n_nonzero);
+}
+
+template <typename eT>
+void CSRMatrixT<eT>::apply(const Col<eT> &x, Col<eT> &y) const {
+  assert(x.n_elem == n_cols);
+  assert(&x != &y);
+
+  if (y.n_elem != n_rows)
+    y.set_size(n_rows);
+
+  const eT *px = x.memptr();
+  eT *py = y.memptr();
+
+#pragma omp parallel
+  {
+#ifdef _OPENMP
+    const uword t = omp_get_thread_num();
+    const uword threads = omp_get_num_threads();
+#else
+    const uword t = 0;
+    const uword threads = 1;
+#endif
+
+    // First rows past t/threads and (t+1)/threads of the nonzeros
+    const uword lo = std::lower_bound(row_ptr.begin(), row_ptr.end() - 1,
+                                      n_nonzero * t / threads) -
+                     row_ptr.begin();
+    const uword hi = std::lower_bound(row_ptr.begin(), row_ptr.end() - 1,
+                                      n_nonzero * (t + 1) / threads) -
+                     row_ptr.begin();
+
+    for (uword i = lo; i < (t + 1 == threads ? n_rows : hi); ++i) {
+      eT sum = 0;
+      for (uword p = row_ptr[i]; p < row_ptr[i + 1]; ++p)
+        sum += val[p] * px[col_ind[p]];
+      py[i] = sum;
+    }
+  }
+}
+
+template <typename eT>
+Col<eT> CSRMatrixT<eT>::operator*(const Col<eT> &x) const {
+  Col<eT> y(n_rows);
+  apply(x, y);
+  return y;
+}
+
+template class CSRMatrixT<Real>;
+template class CSRMatrixT<float>;
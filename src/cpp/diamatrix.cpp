@@ -0,0 +1,152 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file diamatrix.cpp
+ *
+ * @brief Diagonal (stencil-compressed) storage of banded operators
+ *
+ * @date 2024/10/15
+ */
+
+#include "diamatrix.h"
+#include <cassert>
+
+// Long runs are split so that the segments spread evenly over threads
+static const uword max_segment = 1024;
+
+DIAMatrix::DIAMatrix(const sp_mat &A, uword min_run)
+    : n_rows(A.n_rows), n_cols(A.n_cols) {
+  assert(min_run > 0);
+
+  // The columns of A^T are the rows of A
+  sp_mat At = A.t();
+  At.sync();
+  n_nonzero = At.n_nonzero;
+
+  const uword *rp = At.col_ptrs;
+  const uword *ci = At.row_indices;
+  const Real *v = At.values;
+
+  // Same taps relative to the first column, and the same column shift
+  auto same = [&](uword a, uword b) {
+    const uword n = rp[a + 1] - rp[a];
+    if (n == 0 || n != rp[b + 1] - rp[b])
+      return false;
+    const uword pa = rp[a], pb = rp[b];
+    if (ci[pa] - a != ci[pb] - b)
+      return false;
+    for (uword q = 0; q < n; ++q)
+      if (ci[pa + q] - ci[pa] != ci[pb + q] - ci[pb] || v[pa + q] != v[pb + q])
+        return false;
+    return true;
+  };
+
+  tap_ptr.push_back(0);
+  patch_ptr.push_back(0);
+
+  for (uword i = 0, j; i < n_rows; i = j) {
+    for (j = i + 1; j < n_rows && same(i, j); ++j)
+      ;
+
+    const uword p = rp[i], n = rp[i + 1] - rp[i];
+
+    if (n == 0 || j - i < min_run) {
+      for (uword r = i; r < j; ++r) {
+        patch_row.push_back(r);
+        patch_col.insert(patch_col.end(), ci + rp[r], ci + rp[r + 1]);
+        patch_val.insert(patch_val.end(), v + rp[r], v + rp[r + 1]);
+        patch_ptr.push_back(patch_col.size());
+      }
+      continue;
+    }
+
+    // Reuse a stencil with the same taps
+    uword s = 0;
+    for (; s + 1 < tap_ptr.size(); ++s) {
+      const uword t = tap_ptr[s];
+      if (tap_ptr[s + 1] - t != n)
+        continue;
+      uword q = 0;
+      while (q < n && offsets[t + q] == ci[p + q] - ci[p] &&
+             coefficients[t + q] == v[p + q])
+        ++q;
+      if (q == n)
+        break;
+    }
+    if (s + 1 == tap_ptr.size()) {
+      for (uword q = 0; q < n; ++q) {
+        offsets.push_back(ci[p + q] - ci[p]);
+        coefficients.push_back(v[p + q]);
+      }
+      tap_ptr.push_back(offsets.size());
+    }
+
+    const sword shift = static_cast<sword>(ci[p]) - static_cast<sword>(i);
+    for (uword r = i; r < j; r += max_segment)
+      segments.push_back({r, std::min(r + max_segment, j), shift, s});
+  }
+}
+
+void DIAMatrix::apply(const vec &x, vec &y) const {
+  assert(x.n_elem == n_cols);
+  assert(&x != &y);
+
+  if (y.n_elem != n_rows)
+    y.set_size(n_rows);
+
+  const Real *px = x.memptr();
+  Real *py = y.memptr();
+
+#pragma omp parallel
+  {
+#pragma omp for schedule(static) nowait
+    for (sword g = 0; g < static_cast<sword>(segments.size()); ++g) {
+      const Segment &s = segments[g];
+      const uword len = s.row_end - s.row_begin;
+      const Real *xs = px + (static_cast<sword>(s.row_begin) + s.shift);
+      Real *ys = py + s.row_begin;
+
+      // One unit-stride pass per diagonal
+      for (uword t = tap_ptr[s.stencil]; t < tap_ptr[s.stencil + 1]; ++t) {
+        const Real c = coefficients[t];
+        const Real *xt = xs + offsets[t];
+        if (t == tap_ptr[s.stencil]) {
+#pragma omp simd
+          for (uword i = 0; i < len; ++i)
+            ys[i] = c * xt[i];
+        } else {
+#pragma omp simd
+          for (uword i = 0; i < len; ++i)
+            ys[i] += c * xt[i];
+        }
+      }
+    }
+
+#pragma omp for schedule(static)
+    for (sword r = 0; r < static_cast<sword>(patch_row.size()); ++r) {
+      Real sum = 0.0;
+      for (uword p = patch_ptr[r]; p < patch_ptr[r + 1]; ++p)
+        sum += patch_val[p] * px[patch_col[p]];
+      py[patch_row[r]] = sum;
+    }
+  }
+}
+
+vec DIAMatrix::operator*(const vec &x) const {
+  vec y(n_rows);
+  apply(x, y);
+  return y;
+}
+
+uword DIAMatrix::memory() const {
+  return (tap_ptr.size() + offsets.size() + patch_row.size() +
+          patch_ptr.size() + patch_col.size()) * sizeof(uword) +
+         (coefficients.size() + patch_val.size()) * sizeof(Real) +
+         segments.size() * sizeof(Segment);
+}
+
+uword DIAMatrix::patch_rows() const { return patch_row.size(); }
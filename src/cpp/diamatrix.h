@@ -0,0 +1,92 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file diamatrix.h
+ *
+ * @brief Diagonal (stencil-compressed) storage of banded operators
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef DIAMATRIX_H
+#define DIAMATRIX_H
+
+#include "utils.h"
+#include <vector>
+
+/**
+ * @brief Operator stored as constant diagonals plus a boundary patch
+ *
+ * Away from the boundaries every row of a mimetic operator holds the same
+ * coefficients on the same diagonals. Rows are grouped into segments of
+ * consecutive rows that share one such stencil and one column shift; a
+ * segment is applied diagonal by diagonal, each a unit-stride axpy over
+ * the rows of the segment that the compiler vectorizes. Rows that do not
+ * belong to a long enough run, i.e. those near the boundaries, are kept in
+ * a small CSR patch.
+ *
+ * The column shift lets the rectangular Gradient, Divergence and Interpol
+ * blocks, whose diagonals drift by one at every line of cells, be stored
+ * as one segment per line.
+ *
+ * @code
+ * DIAMatrix A(L); // any Gradient, Divergence, Laplacian, Interpol, sp_mat
+ * A.apply(x, y);
+ * @endcode
+ */
+class DIAMatrix {
+
+public:
+  /**
+   * @param A Sparse matrix
+   * @param min_run Shortest run of identical rows stored as a segment
+   */
+  explicit DIAMatrix(const sp_mat &A, uword min_run = 8);
+
+  /**
+   * @brief y = A * x
+   *
+   * @param x Input vector with n_cols entries
+   * @param y Output vector, resized if needed; must not alias x
+   */
+  void apply(const vec &x, vec &y) const;
+
+  /**
+   * @brief y = A * x
+   */
+  vec operator*(const vec &x) const;
+
+  /**
+   * @brief Bytes held by the coefficients and indices
+   */
+  uword memory() const;
+
+  /**
+   * @brief Number of rows stored in the CSR patch
+   */
+  uword patch_rows() const;
+
+  uword n_rows, n_cols, n_nonzero;
+
+private:
+  struct Segment {
+    uword row_begin, row_end; // Rows [row_begin, row_end)
+    sword shift;              // Column of the first tap is row + shift
+    uword stencil;
+  };
+
+  // Taps of stencil s are offsets/coefficients [tap_ptr[s], tap_ptr[s+1])
+  std::vector<uword> tap_ptr, offsets;
+  std::vector<Real> coefficients;
+  std::vector<Segment> segments;
+
+  // Rows outside the segments, zero rows included
+  std::vector<uword> patch_row, patch_ptr, patch_col;
+  std::vector<Real> patch_val;
+};
+
+#endif // DIAMATRIX_H
@@ -16,6 +16,7 @@
 #ifndef DIVERGENCE_H
 #define DIVERGENCE_H
 
+#include "stencil.h"
 #include "utils.h"
 #include <cassert>
 
@@ -23,10 +24,10 @@
  * @brief Mimetic Divergence operator
  *
  */
-class Divergence : public sp_mat {
+class Divergence : public StencilOperator<Divergence> {
 
 public:
-  using sp_mat::operator=;
+  using StencilOperator<Divergence>::operator=;
 
   /**
    * @brief 1-D Mimetic Divergence Constructor
@@ -68,6 +69,19 @@ public:
    */    
   vec getQ();
 
+  /**
+   * @brief Matrix-free application, y = D * x
+   *
+   * Applies the hard-coded interior stencil along each axis and uses the
+   * assembled rows only near the boundaries. Falls back to the sparse
+   * product once the matrix is assigned or modified; see StencilOperator for
+   * element writes.
+   *
+   * @param x Vector field at faces
+   * @param y Scalar field at centers and boundaries, resized if needed
+   */
+  void apply(const vec &x, vec &y) const;
+
 private:
   vec Q;
 };
@@ -0,0 +1,114 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file eigenbridge.h
+ *
+ * @brief Zero-copy views of Armadillo data as Eigen objects
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef EIGENBRIDGE_H
+#define EIGENBRIDGE_H
+
+#include "utils.h"
+#include <cassert>
+#include <eigen3/Eigen/Sparse>
+#include <limits>
+#include <type_traits>
+
+/**
+ * @brief Wraps Armadillo storage in Eigen maps without copying
+ *
+ * Armadillo and Eigen both store sparse matrices in compressed-column form,
+ * so an sp_mat can be viewed as an Eigen sparse matrix directly. Eigen uses
+ * signed indices, so the view uses the signed type of the same width as
+ * uword; the index arrays are then bitwise identical as long as no index
+ * exceeds its largest value, which is checked.
+ */
+class EigenBridge {
+public:
+  typedef std::make_signed<uword>::type Index;
+  typedef Eigen::SparseMatrix<Real, Eigen::ColMajor, Index> SpMat;
+  typedef Eigen::Map<const SpMat> ConstSpMap;
+  typedef Eigen::Map<const Eigen::Matrix<Real, Eigen::Dynamic, 1>> ConstVecMap;
+  typedef Eigen::Map<Eigen::Matrix<Real, Eigen::Dynamic, 1>> VecMap;
+  typedef Eigen::SparseMatrix<cx_double, Eigen::ColMajor, Index> CxSpMat;
+  typedef Eigen::Map<const CxSpMat> ConstCxSpMap;
+  typedef Eigen::Map<const Eigen::Matrix<cx_double, Eigen::Dynamic, 1>>
+      ConstCxVecMap;
+  typedef Eigen::Map<Eigen::Matrix<cx_double, Eigen::Dynamic, 1>> CxVecMap;
+
+  static_assert(sizeof(Index) == sizeof(uword),
+                "index arrays must have the same width in both libraries");
+
+  /**
+   * @brief Read-only Eigen view of a sparse matrix
+   *
+   * The view is valid until A is modified or destroyed. Sparse products and
+   * expressions read it directly, but solvers such as SparseLU take a
+   * SparseMatrix and convert the view into a copy on every call, so keep one
+   * such copy instead of passing the view repeatedly.
+   *
+   * @param A a sparse matrix
+   */
+  static ConstSpMap map(const sp_mat &A) { return sparse<ConstSpMap>(A); }
+
+  /**
+   * @brief Read-only Eigen view of a complex sparse matrix
+   *
+   * Armadillo's cx_double is std::complex<double>, as in Eigen.
+   *
+   * @param A a complex sparse matrix
+   */
+  static ConstCxSpMap map(const cx_sp_mat &A) {
+    return sparse<ConstCxSpMap>(A);
+  }
+
+  /**
+   * @brief Read-only Eigen view of a vector
+   *
+   * @param v a vector
+   */
+  static ConstVecMap map(const vec &v) {
+    return ConstVecMap(v.memptr(), v.n_elem);
+  }
+
+  /**
+   * @brief Writable Eigen view of a vector
+   *
+   * @param v a vector, must already have its final size
+   */
+  static VecMap map(vec &v) { return VecMap(v.memptr(), v.n_elem); }
+
+  /**
+   * @brief Read-only Eigen view of a complex vector
+   */
+  static ConstCxVecMap map(const cx_vec &v) {
+    return ConstCxVecMap(v.memptr(), v.n_elem);
+  }
+
+  /**
+   * @brief Writable Eigen view of a complex vector
+   */
+  static CxVecMap map(cx_vec &v) { return CxVecMap(v.memptr(), v.n_elem); }
+
+private:
+  template <typename Map, typename eT>
+  static Map sparse(const arma::SpMat<eT> &A) {
+    const uword limit = static_cast<uword>(std::numeric_limits<Index>::max());
+    assert(A.n_rows <= limit && A.n_cols <= limit && A.n_nonzero <= limit);
+    (void)limit;
+
+    A.sync();
+    return Map(A.n_rows, A.n_cols, A.n_nonzero,
+               reinterpret_cast<const Index *>(A.col_ptrs),
+               reinterpret_cast<const Index *>(A.row_indices), A.values);
+  }
+};
+
+#endif // EIGENBRIDGE_H
@@ -0,0 +1,335 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file expression.h
+ *
+ * @brief Lazy expression templates over the mimetic operators
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include "divergence.h"
+#include "gradient.h"
+#include "interpol.h"
+#include "laplacian.h"
+#include <cassert>
+#include <deque>
+
+/**
+ * @brief Pool of scratch vectors reused by every evaluation
+ *
+ * Each operator application in an expression takes the next buffer of the
+ * pool. Evaluating the same expression again takes the same buffers in the
+ * same order, so after the first time step no memory is allocated.
+ */
+class Workspace {
+
+public:
+  Workspace() : next(0) {}
+
+  /**
+   * @brief Next buffer of the pool, sized to n elements
+   */
+  vec &acquire(uword n) {
+    if (next == buffers.size())
+      buffers.emplace_back();
+    vec &v = buffers[next++];
+    v.set_size(n);
+    return v;
+  }
+
+  /**
+   * @brief Makes every buffer available again
+   */
+  void rewind() { next = 0; }
+
+private:
+  std::deque<vec> buffers; // Stable references while growing
+  uword next;
+};
+
+/**
+ * @brief Base of all lazy expressions, y(i) = self()[i]
+ *
+ * Every expression provides size(), operator[] and prepare(). prepare()
+ * runs the operator applications of the tree into workspace buffers, after
+ * which operator[] is a pure element-wise read.
+ */
+template <typename Derived> class Expr {
+public:
+  const Derived &self() const { return static_cast<const Derived &>(*this); }
+};
+
+/**
+ * @brief Leaf referencing an existing vector
+ *
+ * The vector is read through its current memory at evaluation time, so it
+ * may be resized or reallocated after the expression is built.
+ */
+class VecExpr : public Expr<VecExpr> {
+public:
+  explicit VecExpr(const vec &v) : v(v) {}
+
+  uword size() const { return v.n_elem; }
+  Real operator[](uword i) const { return v.memptr()[i]; }
+  void prepare(Workspace &) const {}
+
+  const vec &v;
+};
+
+/**
+ * @brief s * e
+ */
+template <typename E> class ScaledExpr : public Expr<ScaledExpr<E>> {
+public:
+  ScaledExpr(Real s, const E &e) : s(s), e(e) {}
+
+  uword size() const { return e.size(); }
+  Real operator[](uword i) const { return s * e[i]; }
+  void prepare(Workspace &ws) const { e.prepare(ws); }
+
+private:
+  Real s;
+  E e;
+};
+
+/**
+ * @brief e % e
+ */
+template <typename E> class SquareExpr : public Expr<SquareExpr<E>> {
+public:
+  explicit SquareExpr(const E &e) : e(e) {}
+
+  uword size() const { return e.size(); }
+  Real operator[](uword i) const {
+    const Real x = e[i];
+    return x * x;
+  }
+  void prepare(Workspace &ws) const { e.prepare(ws); }
+
+private:
+  E e;
+};
+
+struct ExprAdd {
+  static Real eval(Real a, Real b) { return a + b; }
+};
+
+struct ExprSub {
+  static Real eval(Real a, Real b) { return a - b; }
+};
+
+struct ExprSchur {
+  static Real eval(Real a, Real b) { return a * b; }
+};
+
+/**
+ * @brief Element-wise a + b, a - b or a % b
+ */
+template <typename L, typename R, typename Op>
+class BinaryExpr : public Expr<BinaryExpr<L, R, Op>> {
+public:
+  BinaryExpr(const L &l, const R &r) : l(l), r(r) {
+    assert(l.size() == r.size());
+  }
+
+  uword size() const { return l.size(); }
+  Real operator[](uword i) const { return Op::eval(l[i], r[i]); }
+  void prepare(Workspace &ws) const {
+    l.prepare(ws);
+    r.prepare(ws);
+  }
+
+private:
+  L l;
+  R r;
+};
+
+/**
+ * @brief How an operator is applied to a vector, y = A * x
+ *
+ * The general case is a sparse product into y's memory; operators with a
+ * matrix-free apply() use it instead.
+ */
+template <typename Op> struct ExprKernel {
+  static void apply(const sp_mat &A, const vec &x, vec &y) {
+    A.sync();
+    y.zeros(A.n_rows);
+    Real *py = y.memptr();
+    for (uword j = 0; j < A.n_cols; ++j) {
+      const Real xj = x(j);
+      for (uword p = A.col_ptrs[j]; p < A.col_ptrs[j + 1]; ++p)
+        py[A.row_indices[p]] += A.values[p] * xj;
+    }
+  }
+};
+
+template <> struct ExprKernel<Gradient> {
+  static void apply(const Gradient &G, const vec &x, vec &y) { G.apply(x, y); }
+};
+
+template <> struct ExprKernel<Divergence> {
+  static void apply(const Divergence &D, const vec &x, vec &y) {
+    D.apply(x, y);
+  }
+};
+
+template <> struct ExprKernel<Laplacian> {
+  static void apply(const Laplacian &L, const vec &x, vec &y) {
+    L.apply(x, y);
+  }
+};
+
+// Operands of an operator must exist in memory; leaves already do
+inline const vec &materialize(const VecExpr &e, Workspace &) { return e.v; }
+
+template <typename E>
+const vec &materialize(const Expr<E> &e, Workspace &ws) {
+  const E &x = e.self();
+  vec &v = ws.acquire(x.size());
+  Real *p = v.memptr();
+  for (uword i = 0; i < v.n_elem; ++i)
+    p[i] = x[i];
+  return v;
+}
+
+/**
+ * @brief A * e, evaluated once into a workspace buffer by prepare()
+ */
+template <typename Op, typename E>
+class ApplyExpr : public Expr<ApplyExpr<Op, E>> {
+public:
+  ApplyExpr(const Op &A, const E &e) : A(A), e(e), y(nullptr) {
+    assert(A.n_cols == e.size());
+  }
+
+  uword size() const { return A.n_rows; }
+  Real operator[](uword i) const { return p[i]; }
+  void prepare(Workspace &ws) const {
+    e.prepare(ws);
+    const vec &x = materialize(e, ws);
+    vec &out = ws.acquire(A.n_rows);
+    ExprKernel<Op>::apply(A, x, out);
+    y = &out;
+    p = out.memptr();
+  }
+
+  const vec &result() const { return *y; }
+
+private:
+  const Op &A;
+  E e;
+  mutable const vec *y;
+  mutable const Real *p;
+};
+
+// Nested applications hand over their buffer
+template <typename Op, typename E>
+const vec &materialize(const ApplyExpr<Op, E> &e, Workspace &) {
+  return e.result();
+}
+
+/**
+ * @brief Starts a lazy expression from a vector
+ *
+ * @code
+ * Workspace ws;
+ * VecExpr c = lazy(C);
+ * for (int i = 0; i < steps; ++i)
+ *   evaluate(c + dt * (D * (dis * (G * c)) - D * (lazy(V) % (I * c))), C, ws);
+ * @endcode
+ */
+inline VecExpr lazy(const vec &v) { return VecExpr(v); }
+
+template <typename L, typename R>
+BinaryExpr<L, R, ExprAdd> operator+(const Expr<L> &l, const Expr<R> &r) {
+  return BinaryExpr<L, R, ExprAdd>(l.self(), r.self());
+}
+
+template <typename L, typename R>
+BinaryExpr<L, R, ExprSub> operator-(const Expr<L> &l, const Expr<R> &r) {
+  return BinaryExpr<L, R, ExprSub>(l.self(), r.self());
+}
+
+template <typename L, typename R>
+BinaryExpr<L, R, ExprSchur> operator%(const Expr<L> &l, const Expr<R> &r) {
+  return BinaryExpr<L, R, ExprSchur>(l.self(), r.self());
+}
+
+template <typename E> ScaledExpr<E> operator*(Real s, const Expr<E> &e) {
+  return ScaledExpr<E>(s, e.self());
+}
+
+template <typename E> ScaledExpr<E> operator*(const Expr<E> &e, Real s) {
+  return ScaledExpr<E>(s, e.self());
+}
+
+template <typename E> ScaledExpr<E> operator-(const Expr<E> &e) {
+  return ScaledExpr<E>(-1.0, e.self());
+}
+
+template <typename E> SquareExpr<E> square(const Expr<E> &e) {
+  return SquareExpr<E>(e.self());
+}
+
+template <typename E>
+ApplyExpr<Gradient, E> operator*(const Gradient &G, const Expr<E> &e) {
+  return ApplyExpr<Gradient, E>(G, e.self());
+}
+
+template <typename E>
+ApplyExpr<Divergence, E> operator*(const Divergence &D, const Expr<E> &e) {
+  return ApplyExpr<Divergence, E>(D, e.self());
+}
+
+template <typename E>
+ApplyExpr<Laplacian, E> operator*(const Laplacian &L, const Expr<E> &e) {
+  return ApplyExpr<Laplacian, E>(L, e.self());
+}
+
+template <typename E>
+ApplyExpr<sp_mat, E> operator*(const Interpol &I, const Expr<E> &e) {
+  return ApplyExpr<sp_mat, E>(I, e.self());
+}
+
+template <typename E>
+ApplyExpr<sp_mat, E> operator*(const sp_mat &A, const Expr<E> &e) {
+  return ApplyExpr<sp_mat, E>(A, e.self());
+}
+
+/**
+ * @brief y = e in one fused pass
+ *
+ * Operator applications are evaluated first, into the workspace; then every
+ * element of y is computed from the leaves and those buffers in a single
+ * sweep. Since element i is read only at index i, y may appear in e, which
+ * makes evaluate(lazy(y) + ..., y, ws) an in-place update.
+ *
+ * @param e Expression
+ * @param y Output, resized if needed
+ * @param ws Scratch buffers, reused across calls
+ */
+template <typename E> void evaluate(const Expr<E> &e, vec &y, Workspace &ws) {
+  const E &x = e.self();
+
+  ws.rewind();
+  x.prepare(ws);
+
+  const uword n = x.size();
+  if (y.n_elem != n)
+    y.set_size(n);
+  Real *py = y.memptr();
+
+#pragma omp parallel for schedule(static) if (n > 32768)
+  for (sword i = 0; i < static_cast<sword>(n); ++i)
+    py[i] = x[i];
+}
+
+#endif // EXPRESSION_H
@@ -0,0 +1,223 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file fastpoisson.cpp
+ *
+ * @brief Transform-based Poisson solver for uniform boxes
+ *
+ * @date 2024/10/15
+ */
+
+#include "fastpoisson.h"
+#include "boundarypatch.h"
+#include "laplacian.h"
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+FastPoisson::FastPoisson(u16 k, u32 m, Real dx, Real a, Real b)
+    : k(k), a(a), b(b) {
+  setup({m}, {dx});
+  if (!exact()) {
+    A = Laplacian(k, m, dx);
+    BoundaryPatch::robin(k, m, dx, a, b).add_to(A);
+  }
+}
+
+FastPoisson::FastPoisson(u16 k, u32 m, u32 n, Real dx, Real dy, Real a,
+                         Real b)
+    : k(k), a(a), b(b) {
+  setup({m, n}, {dx, dy});
+  if (!exact()) {
+    A = Laplacian(k, m, n, dx, dy);
+    BoundaryPatch::robin(k, m, dx, n, dy, a, b).add_to(A);
+  }
+}
+
+FastPoisson::FastPoisson(u16 k, u32 m, u32 n, u32 o, Real dx, Real dy,
+                         Real dz, Real a, Real b)
+    : k(k), a(a), b(b) {
+  setup({m, n, o}, {dx, dy, dz});
+  if (!exact()) {
+    A = Laplacian(k, m, n, o, dx, dy, dz);
+    BoundaryPatch::robin(k, m, dx, n, dy, o, dz, a, b).add_to(A);
+  }
+}
+
+void FastPoisson::setup(const std::vector<u32> &cells,
+                        const std::vector<Real> &spacing) {
+  if ((a == 0.0) == (b == 0.0))
+    throw std::invalid_argument(
+        "FastPoisson needs pure Dirichlet or pure Neumann boundaries");
+
+  neumann = (a == 0.0);
+  dims = cells.size();
+
+  const Real pi = std::acos(-1.0);
+
+  for (u32 d = 0; d < 3; ++d) {
+    if (d >= dims) {
+      size[d] = 1;
+      h[d] = 1.0;
+      continue;
+    }
+
+    const u32 m = cells[d];
+    assert(m >= 2);
+
+    size[d] = m + 2;
+    h[d] = spacing[d];
+    fft.emplace_back(m);
+
+    // Cell-centered second difference with reflecting (Neumann) or
+    // antireflecting (Dirichlet) ends
+    vec lambda(m);
+    for (u32 j = 0; j < m; ++j) {
+      const Real s = std::sin(pi * (neumann ? j : j + 1) / (2.0 * m));
+      lambda(j) = -4.0 * s * s / (h[d] * h[d]);
+    }
+    eig.push_back(lambda);
+  }
+}
+
+bool FastPoisson::exact() const { return k == 2 && neumann; }
+
+void FastPoisson::apply(const vec &r, vec &z) const {
+  const uword st[3] = {1, size[0], size[0] * size[1]};
+  assert(r.n_elem == st[2] * size[2]);
+
+  // Interior cells per axis and their offset in the full grid
+  uword c[3], off[3];
+  for (u32 d = 0; d < 3; ++d) {
+    c[d] = d < dims ? size[d] - 2 : 1;
+    off[d] = d < dims ? 1 : 0;
+  }
+
+  const uword N = c[0] * c[1] * c[2];
+  vec g(N);
+
+  // Gather the interior rows, moving the boundary rows to the right
+  for (uword i2 = 0; i2 < c[2]; ++i2) {
+    for (uword i1 = 0; i1 < c[1]; ++i1) {
+      for (uword i0 = 0; i0 < c[0]; ++i0) {
+        const uword i[3] = {i0, i1, i2};
+        const uword p = (i0 + off[0]) * st[0] + (i1 + off[1]) * st[1] +
+                        (i2 + off[2]) * st[2];
+        Real s = r(p);
+
+        for (u32 d = 0; d < dims; ++d) {
+          // Neumann rows fix the boundary flux, Dirichlet rows the value
+          const Real w = neumann ? 1.0 / (b * h[d])
+                                 : 8.0 / (3.0 * a * h[d] * h[d]);
+          if (i[d] == 0)
+            s -= w * r(p - st[d]);
+          if (i[d] == c[d] - 1)
+            s -= w * r(p + st[d]);
+        }
+
+        g(i0 + c[0] * (i1 + c[1] * i2)) = s;
+      }
+    }
+  }
+
+  // Diagonalize along every axis, scale, and transform back
+  for (int pass = 0; pass < 2; ++pass) {
+    for (u32 d = 0; d < dims; ++d) {
+      const uword stride = d == 0 ? 1 : (d == 1 ? c[0] : c[0] * c[1]);
+      const sword lines = N / c[d];
+
+#pragma omp parallel
+      {
+        std::vector<Real> line(c[d]);
+
+#pragma omp for schedule(static)
+        for (sword l = 0; l < lines; ++l) {
+          const uword base = (l % stride) + (l / stride) * stride * c[d];
+          for (uword j = 0; j < c[d]; ++j)
+            line[j] = g(base + j * stride);
+
+          if (pass == 0)
+            neumann ? fft[d].dct(line.data()) : fft[d].dst(line.data());
+          else
+            neumann ? fft[d].idct(line.data()) : fft[d].idst(line.data());
+
+          for (uword j = 0; j < c[d]; ++j)
+            g(base + j * stride) = line[j];
+        }
+      }
+    }
+
+    if (pass == 1)
+      break;
+
+#pragma omp parallel for schedule(static)
+    for (sword q = 0; q < static_cast<sword>(N); ++q) {
+      uword j = q;
+      Real lambda = 0.0;
+      for (u32 d = 0; d < dims; ++d) {
+        lambda += eig[d](j % c[d]);
+        j /= c[d];
+      }
+      // The constant Neumann mode is in the null space
+      g(q) = lambda == 0.0 ? 0.0 : g(q) / lambda;
+    }
+  }
+
+  z.zeros(r.n_elem);
+  for (uword i2 = 0; i2 < c[2]; ++i2)
+    for (uword i1 = 0; i1 < c[1]; ++i1)
+      for (uword i0 = 0; i0 < c[0]; ++i0)
+        z((i0 + off[0]) * st[0] + (i1 + off[1]) * st[1] +
+          (i2 + off[2]) * st[2]) = g(i0 + c[0] * (i1 + c[1] * i2));
+
+  // Boundary nodes, one axis at a time. Rows of axis d span every node of
+  // the previous axes, so the corners are filled last.
+  for (u32 d = 0; d < dims; ++d) {
+    uword lo[3], hi[3], step[3];
+    for (u32 e = 0; e < 3; ++e) {
+      lo[e] = e < d ? 0 : off[e];
+      hi[e] = e < d ? size[e] : off[e] + c[e];
+      step[e] = 1;
+    }
+    lo[d] = 0;
+    hi[d] = size[d];
+    step[d] = size[d] - 1;
+
+    for (uword i2 = lo[2]; i2 < hi[2]; i2 += step[2]) {
+      for (uword i1 = lo[1]; i1 < hi[1]; i1 += step[1]) {
+        for (uword i0 = lo[0]; i0 < hi[0]; i0 += step[0]) {
+          const uword i[3] = {i0, i1, i2};
+          const uword p = i0 * st[0] + i1 * st[1] + i2 * st[2];
+
+          if (!neumann) {
+            z(p) = r(p) / a;
+            continue;
+          }
+
+          // Inverts the one-sided k = 2 gradient, (8/3, -3, 1/3) / h
+          const uword s = st[d];
+          const uword q1 = i[d] == 0 ? p + s : p - s;
+          const uword q2 = i[d] == 0 ? p + 2 * s : p - 2 * s;
+          z(p) = 3.0 / 8.0 * (3.0 * z(q1) - z(q2) / 3.0 + r(p) * h[d] / b);
+        }
+      }
+    }
+  }
+}
+
+KrylovResult FastPoisson::solve(const vec &rhs, vec &x,
+                                const KrylovOptions &opts) const {
+  if (!exact())
+    return Krylov::gmres(A, rhs, x, this, opts);
+
+  KrylovResult result;
+  apply(rhs, x);
+  result.converged = true;
+  result.iterations = 1;
+  result.history.push_back(0.0);
+  return result;
+}
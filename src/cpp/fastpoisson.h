@@ -0,0 +1,103 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file fastpoisson.h
+ *
+ * @brief Transform-based Poisson solver for uniform boxes
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef FASTPOISSON_H
+#define FASTPOISSON_H
+
+#include "fft.h"
+#include "krylov.h"
+#include <vector>
+
+/**
+ * @brief O(N log N) solver for Laplacian + RobinBC on a uniform box
+ *
+ * Supports homogeneous-type boundaries of a single kind, pure Neumann
+ * (a = 0) or pure Dirichlet (b = 0). The boundary rows are eliminated and
+ * the remaining cell-centered problem is diagonalized by a DCT-II (Neumann)
+ * or DST-II (Dirichlet) along every axis.
+ *
+ * For k = 2 with Neumann boundaries the reduced operator is exactly the
+ * one the DCT diagonalizes, so apply() is a direct solve. The singular
+ * constant mode is dropped, which returns the zero-mean solution when the
+ * right-hand side is compatible. In every other case (k > 2, or Dirichlet,
+ * whose one-sided boundary stencil couples the first cell differently from
+ * the DST) apply() is a spectrally close approximation, and solve() runs
+ * GMRES on the assembled operator with it as the preconditioner.
+ *
+ * @code
+ * FastPoisson fp(k, m, n, dx, dy, 0, 1);
+ * vec u;
+ * fp.solve(rhs, u);
+ * @endcode
+ */
+class FastPoisson : public Preconditioner {
+
+public:
+  /**
+   * @brief 1-D Laplacian + RobinBC
+   *
+   * @param k Order of accuracy
+   * @param m Number of cells
+   * @param dx Spacing between cells
+   * @param a Dirichlet coefficient of RobinBC
+   * @param b Neumann coefficient of RobinBC
+   */
+  FastPoisson(u16 k, u32 m, Real dx, Real a, Real b);
+
+  /**
+   * @brief 2-D Laplacian + RobinBC
+   */
+  FastPoisson(u16 k, u32 m, u32 n, Real dx, Real dy, Real a, Real b);
+
+  /**
+   * @brief 3-D Laplacian + RobinBC
+   */
+  FastPoisson(u16 k, u32 m, u32 n, u32 o, Real dx, Real dy, Real dz, Real a,
+              Real b);
+
+  /**
+   * @brief Whether apply() solves the system exactly
+   */
+  bool exact() const;
+
+  /**
+   * @brief Solves (Laplacian + RobinBC) * x = rhs
+   *
+   * @param rhs Right-hand side, including the boundary rows
+   * @param x Solution; initial guess of GMRES when it has the size of rhs
+   * @param opts Stopping criteria of GMRES, unused when exact()
+   */
+  KrylovResult solve(const vec &rhs, vec &x,
+                     const KrylovOptions &opts = KrylovOptions()) const;
+
+  /**
+   * @brief Transform solve, z ~ (Laplacian + RobinBC)^-1 * r
+   */
+  void apply(const vec &r, vec &z) const override;
+
+private:
+  void setup(const std::vector<u32> &cells, const std::vector<Real> &spacing);
+
+  u16 k;
+  Real a, b;
+  bool neumann;
+  u32 dims;
+  uword size[3];          // Grid points per axis, boundary nodes included
+  Real h[3];              // Spacing per axis
+  std::vector<FFT> fft;   // One transform per axis
+  std::vector<vec> eig;   // Eigenvalues of the 1-D reduced operators
+  sp_mat A;               // Assembled operator, only when !exact()
+};
+
+#endif // FASTPOISSON_H
@@ -0,0 +1,154 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file fft.cpp
+ *
+ * @brief Fast Fourier and trigonometric transforms
+ *
+ * @date 2024/10/15
+ */
+
+#include "fft.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+FFT::FFT(uword n) : n(n), p(1) {
+  assert(n > 0);
+
+  // Bluestein convolves with a chirp of length 2n-1
+  if (n & (n - 1))
+    while (p < 2 * n - 1)
+      p *= 2;
+  else
+    p = n;
+
+  const Real pi = std::acos(-1.0);
+
+  twiddle.resize(p / 2);
+  for (uword j = 0; j < p / 2; ++j)
+    twiddle[j] = std::polar(1.0, -2.0 * pi * j / p);
+
+  if (p != n) {
+    chirp.resize(n);
+    filter.assign(p, 0.0);
+    for (uword j = 0; j < n; ++j) {
+      // j^2 mod 2n keeps the angle small for large j
+      chirp[j] = std::polar(1.0, -pi * ((j * j) % (2 * n)) / n);
+      filter[j] = std::conj(chirp[j]);
+      if (j > 0)
+        filter[p - j] = filter[j];
+    }
+    radix2(filter.data());
+  }
+
+  shift.resize(n);
+  for (uword k = 0; k < n; ++k)
+    shift[k] = std::polar(1.0, -pi * k / (2.0 * n));
+}
+
+uword FFT::size() const { return n; }
+
+// Iterative Cooley-Tukey of length p
+void FFT::radix2(Complex *x) const {
+  for (uword i = 1, j = 0; i < p; ++i) {
+    uword bit = p >> 1;
+    for (; j & bit; bit >>= 1)
+      j ^= bit;
+    j ^= bit;
+    if (i < j)
+      std::swap(x[i], x[j]);
+  }
+
+  for (uword len = 2; len <= p; len *= 2) {
+    const uword step = p / len;
+    for (uword i = 0; i < p; i += len) {
+      for (uword j = 0; j < len / 2; ++j) {
+        const Complex u = x[i + j];
+        const Complex v = x[i + j + len / 2] * twiddle[j * step];
+        x[i + j] = u + v;
+        x[i + j + len / 2] = u - v;
+      }
+    }
+  }
+}
+
+void FFT::forward(Complex *x) const {
+  if (p == n) {
+    radix2(x);
+    return;
+  }
+
+  // X(k) = chirp(k) * sum_j (x(j) chirp(j)) conj(chirp(k - j))
+  std::vector<Complex> a(p, 0.0);
+  for (uword j = 0; j < n; ++j)
+    a[j] = x[j] * chirp[j];
+
+  radix2(a.data());
+  for (uword j = 0; j < p; ++j)
+    a[j] = std::conj(a[j] * filter[j]);
+  radix2(a.data());
+
+  for (uword k = 0; k < n; ++k)
+    x[k] = chirp[k] * std::conj(a[k]) / Real(p);
+}
+
+void FFT::inverse(Complex *x) const {
+  for (uword j = 0; j < n; ++j)
+    x[j] = std::conj(x[j]);
+
+  forward(x);
+
+  for (uword j = 0; j < n; ++j)
+    x[j] = std::conj(x[j]) / Real(n);
+}
+
+// Even entries in order followed by odd entries in reverse, then one FFT
+void FFT::dct(Real *x) const {
+  std::vector<Complex> v(n);
+  for (uword j = 0; 2 * j < n; ++j)
+    v[j] = x[2 * j];
+  for (uword j = 0; 2 * j + 1 < n; ++j)
+    v[n - 1 - j] = x[2 * j + 1];
+
+  forward(v.data());
+
+  for (uword k = 0; k < n; ++k)
+    x[k] = std::real(shift[k] * v[k]);
+}
+
+void FFT::idct(Real *x) const {
+  // The FFT of a real sequence is recovered from X(k) and X(n - k)
+  std::vector<Complex> v(n);
+  v[0] = x[0];
+  for (uword k = 1; k < n; ++k)
+    v[k] = std::conj(shift[k]) * Complex(x[k], -x[n - k]);
+
+  inverse(v.data());
+
+  for (uword j = 0; 2 * j < n; ++j)
+    x[2 * j] = std::real(v[j]);
+  for (uword j = 0; 2 * j + 1 < n; ++j)
+    x[2 * j + 1] = std::real(v[n - 1 - j]);
+}
+
+// DST-II(x)(k) = DCT-II((-1)^j x(j))(n - 1 - k)
+void FFT::dst(Real *x) const {
+  for (uword j = 1; j < n; j += 2)
+    x[j] = -x[j];
+
+  dct(x);
+  std::reverse(x, x + n);
+}
+
+void FFT::idst(Real *x) const {
+  std::reverse(x, x + n);
+  idct(x);
+
+  for (uword j = 1; j < n; j += 2)
+    x[j] = -x[j];
+}
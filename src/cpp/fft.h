@@ -0,0 +1,92 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file fft.h
+ *
+ * @brief Fast Fourier and trigonometric transforms
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef FFT_H
+#define FFT_H
+
+#include "utils.h"
+#include <complex>
+#include <vector>
+
+/**
+ * @brief Transforms of a fixed length n in O(n log n)
+ *
+ * Lengths that are powers of two use an iterative radix-2 FFT, any other
+ * length is reduced to one by Bluestein's chirp-z algorithm. The real
+ * transforms use Makhoul's mapping onto a complex FFT of the same length.
+ * All transforms work in place and are safe to call concurrently.
+ *
+ * @code
+ * FFT fft(m);
+ * fft.dct(x.memptr());  // X(k) = sum_j x(j) cos(pi k (2j+1) / 2m)
+ * fft.idct(x.memptr()); // back to x
+ * @endcode
+ */
+class FFT {
+
+public:
+  typedef std::complex<Real> Complex;
+
+  /**
+   * @param n Transform length
+   */
+  explicit FFT(uword n);
+
+  /**
+   * @brief Transform length
+   */
+  uword size() const;
+
+  /**
+   * @brief X(k) = sum_j x(j) exp(-2 pi i j k / n)
+   */
+  void forward(Complex *x) const;
+
+  /**
+   * @brief Inverse of forward(), including the 1/n factor
+   */
+  void inverse(Complex *x) const;
+
+  /**
+   * @brief DCT-II, X(k) = sum_j x(j) cos(pi k (2j+1) / 2n)
+   */
+  void dct(Real *x) const;
+
+  /**
+   * @brief Inverse of dct(), a scaled DCT-III
+   */
+  void idct(Real *x) const;
+
+  /**
+   * @brief DST-II, X(k) = sum_j x(j) sin(pi (k+1) (2j+1) / 2n)
+   */
+  void dst(Real *x) const;
+
+  /**
+   * @brief Inverse of dst(), a scaled DST-III
+   */
+  void idst(Real *x) const;
+
+private:
+  void radix2(Complex *x) const;
+
+  uword n;                       // Transform length
+  uword p;                       // Power-of-two length of the radix-2 FFT
+  std::vector<Complex> twiddle;  // exp(-2 pi i j / p), j < p/2
+  std::vector<Complex> chirp;    // exp(-pi i j^2 / n), Bluestein only
+  std::vector<Complex> filter;   // FFT of the conjugate chirp, Bluestein only
+  std::vector<Complex> shift;    // exp(-pi i k / 2n) of the real transforms
+};
+
+#endif // FFT_H
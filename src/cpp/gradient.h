@@ -17,6 +17,7 @@
 #ifndef GRADIENT_H
 #define GRADIENT_H
 
+#include "stencil.h"
 #include "utils.h"
 #include <cassert>
 
@@ -24,10 +25,10 @@
  * @brief Mimetic Gradient operator
  *
  */
-class Gradient : public sp_mat {
+class Gradient : public StencilOperator<Gradient> {
 
 public:
-  using sp_mat::operator=;
+  using StencilOperator<Gradient>::operator=;
 
   /**
    * @brief 1-D Mimetic Gradient Constructor
@@ -70,6 +71,19 @@ public:
    */  
   vec getP();
 
+  /**
+   * @brief Matrix-free application, y = G * x
+   *
+   * Applies the hard-coded interior stencil along each axis and uses the
+   * assembled rows only near the boundaries. Falls back to the sparse
+   * product once the matrix is assigned or modified; see StencilOperator for
+   * element writes.
+   *
+   * @param x Scalar field at centers and boundaries
+   * @param y Vector field at faces, resized if needed
+   */
+  void apply(const vec &x, vec &y) const;
+
 private:
   vec P;
 };
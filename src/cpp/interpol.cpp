@@ -16,17 +16,21 @@
 #include "interpol.h"
 
 // 1-D Constructor
-Interpol::Interpol(u32 m, Real c) : sp_mat(m + 1, m + 2) {
+Interpol::Interpol(u32 m, Real c) {
   assert(m >= 4);
   assert(c >= 0 && c <= 1);
 
-  at(0, 0) = 1;
-  at(m, m + 1) = 1;
+  Triplets T(m + 1, m + 2, 2 * m);
+
+  T.at(0, 0) = 1;
+  T.at(m, m + 1) = 1;
 
   for (u32 i = 1; i < m; i++) {
-    at(i, i) = c;
-    at(i, i + 1) = 1 - c;
+    T.at(i, i) = c;
+    T.at(i, i + 1) = 1 - c;
   }
+
+  *this = T.assemble();
 }
 
 // 2-D Constructor
@@ -42,18 +46,12 @@ Interpol::Interpol(u32 m, u32 n, Real c1, Real c2) {
   In.shed_row(0);
   In.shed_row(n);
 
-  sp_mat I1 = Utils::spkron(In, Ix);
-  sp_mat I2 = Utils::spkron(Iy, Im);
-
   // Dimensions = 2*m*n+m+n, (m+2)*(n+2)
-  if (m != n)
-    *this = Utils::spjoin_cols(I1, I2);
-  else {
-    sp_mat A1(2, 1);
-    sp_mat A2(2, 1);
-    A1(0, 0) = A2(1, 0) = 1.0;
-    *this = Utils::spkron(A1, I1) + Utils::spkron(A2, I2);
-  }
+  const uword r1 = Ix.n_rows * n;
+  const uword r2 = Iy.n_rows * m;
+
+  *this = Utils::spkron_sum({KronTerm(In, Ix, 0, 0), KronTerm(Iy, Im, r1, 0)},
+                            r1 + r2, (m + 2) * (n + 2));
 }
 
 // 3-D Constructor
@@ -73,39 +71,37 @@ Interpol::Interpol(u32 m, u32 n, u32 o, Real c1, Real c2, Real c3) {
   Io.shed_row(0);
   Io.shed_row(o);
 
-  sp_mat I1 = Utils::spkron(Utils::spkron(Io, In), Ix);
-  sp_mat I2 = Utils::spkron(Utils::spkron(Io, Iy), Im);
-  sp_mat I3 = Utils::spkron(Utils::spkron(Iz, In), Im);
-
   // Dimensions = 3*m*n*o+m*n+m*o+n*o, (m+2)*(n+2)*(o+2)
-  if ((m != n) || (n != o))
-    *this = Utils::spjoin_cols(Utils::spjoin_cols(I1, I2), I3);
-  else {
-    sp_mat A1(3, 1);
-    sp_mat A2(3, 1);
-    sp_mat A3(3, 1);
-    A1(0, 0) = A2(1, 0) = A3(2, 0) = 1.0;
-    *this =
-        Utils::spkron(A1, I1) + Utils::spkron(A2, I2) + Utils::spkron(A3, I3);
-  }
+  const uword r1 = Ix.n_rows * n * o;
+  const uword r2 = Iy.n_rows * m * o;
+  const uword r3 = Iz.n_rows * m * n;
+
+  *this = Utils::spkron_sum({KronTerm(Io, In, Ix, 0, 0),
+                             KronTerm(Io, Iy, Im, r1, 0),
+                             KronTerm(Iz, In, Im, r1 + r2, 0)},
+                            r1 + r2 + r3, (m + 2) * (n + 2) * (o + 2));
 }
 
 // 1-D Constructor for second type
-Interpol::Interpol(bool type, u32 m, Real c) : sp_mat(m + 2, m + 1) {
+Interpol::Interpol(bool type, u32 m, Real c) {
   assert(m >= 4 && "m >= 4");
   assert(c >= 0 && c <= 1 && "0 <= c <= 1");
 
-  at(0, 0) = 1;
-  at(m + 2 - 1, m + 1 - 1) = 1;
+  Triplets T(m + 2, m + 1, 2 * m + 2);
+
+  T.at(0, 0) = 1;
+  T.at(m + 2 - 1, m + 1 - 1) = 1;
 
   vec avg = {c, 1 - c};
 
   int j = 0;
   for (int i = 1; i < m + 1; ++i) {
-    at(i, j) = avg(0);
-    at(i, j + 1) = avg(1);
+    T.at(i, j) = avg(0);
+    T.at(i, j + 1) = avg(1);
     j++;
   }
+
+  *this = T.assemble();
 }
 
 // 2-D Constructor for second type
@@ -119,10 +115,11 @@ Interpol::Interpol(bool type, u32 m, u32 n, Real c1, Real c2) {
   sp_mat In(n + 2, n);
   In.submat(1, 0, n, n - 1) = speye(n, n);
 
-  sp_mat Sx = Utils::spkron(In, Ix);
-  sp_mat Sy = Utils::spkron(Iy, Im);
+  const uword n1 = Ix.n_cols * n;
+  const uword n2 = Iy.n_cols * m;
 
-  *this = Utils::spjoin_rows(Sx, Sy);
+  *this = Utils::spkron_sum({KronTerm(In, Ix, 0, 0), KronTerm(Iy, Im, 0, n1)},
+                            (m + 2) * (n + 2), n1 + n2);
 }
 
 // 3-D Constructor for second type
@@ -140,9 +137,12 @@ Interpol::Interpol(bool type, u32 m, u32 n, u32 o, Real c1, Real c2, Real c3) {
   sp_mat Io(o + 2, o);
   Io.submat(1, 0, o, o - 1) = speye(o, o);
 
-  sp_mat Sx = Utils::spkron(Utils::spkron(Io, In), Ix);
-  sp_mat Sy = Utils::spkron(Utils::spkron(Io, Iy), Im);
-  sp_mat Sz = Utils::spkron(Utils::spkron(Iz, In), Im);
+  const uword n1 = Ix.n_cols * n * o;
+  const uword n2 = Iy.n_cols * m * o;
+  const uword n3 = Iz.n_cols * m * n;
 
-  *this = Utils::spjoin_rows(Utils::spjoin_rows(Sx, Sy), Sz);
+  *this = Utils::spkron_sum({KronTerm(Io, In, Ix, 0, 0),
+                             KronTerm(Io, Iy, Im, 0, n1),
+                             KronTerm(Iz, In, Im, 0, n1 + n2)},
+                            (m + 2) * (n + 2) * (o + 2), n1 + n2 + n3);
 }
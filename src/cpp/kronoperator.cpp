@@ -0,0 +1,289 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file kronoperator.cpp
+ *
+ * @brief Unassembled sums of Kronecker products of 1-D operators
+ *
+ * @date 2024/10/15
+ */
+
+#include "kronoperator.h"
+#include "divergence.h"
+#include "gradient.h"
+#include "laplacian.h"
+#include <algorithm>
+#include <cassert>
+
+KronOperator::KronOperator(const std::vector<KronTerm> &terms, uword n_rows,
+                           uword n_cols)
+    : n_rows(n_rows), n_cols(n_cols) {
+  for (const KronTerm &t : terms) {
+    assert(t.row_offset + t.n_rows <= n_rows);
+    assert(t.col_offset + t.n_cols <= n_cols);
+
+    Term term;
+    term.row_offset = t.row_offset;
+    term.col_offset = t.col_offset;
+
+    for (const sp_mat *A : t.factors) {
+      Factor f;
+      f.n_rows = A->n_rows;
+      f.n_cols = A->n_cols;
+
+      // The columns of A^T are the rows of A
+      sp_mat At = A->t();
+      At.sync();
+      f.row_ptr.assign(At.col_ptrs, At.col_ptrs + At.n_cols + 1);
+      f.col_ind.assign(At.row_indices, At.row_indices + At.n_nonzero);
+      f.val.assign(At.values, At.values + At.n_nonzero);
+
+      f.identity = A->n_rows == A->n_cols && At.n_nonzero == A->n_rows;
+      for (uword i = 0; f.identity && i < A->n_rows; ++i)
+        f.identity = f.row_ptr[i + 1] == i + 1 && f.col_ind[i] == i &&
+                     f.val[i] == 1.0;
+
+      term.factors.push_back(f);
+    }
+
+    this->terms.push_back(term);
+  }
+}
+
+// Identities of size c+2 with the first and last row or column removed
+static sp_mat shed_rows(u32 c) {
+  sp_mat I = speye(c + 2, c + 2);
+  I.shed_row(0);
+  I.shed_row(c);
+  return I;
+}
+
+static sp_mat shed_cols(u32 c) {
+  sp_mat I = speye(c + 2, c + 2);
+  I.shed_col(0);
+  I.shed_col(c);
+  return I;
+}
+
+// Identity of size c+2 with zero corners
+static sp_mat interior(u32 c) {
+  sp_mat I = speye(c + 2, c + 2);
+  I.at(0, 0) = 0;
+  I.at(c + 1, c + 1) = 0;
+  return I;
+}
+
+KronOperator KronOperator::gradient(u16 k, u32 m, u32 n, Real dx, Real dy) {
+  Gradient Gx(k, m, dx);
+  Gradient Gy(k, n, dy);
+  sp_mat Im = shed_rows(m), In = shed_rows(n);
+
+  const uword r1 = Gx.n_rows * n;
+  const uword r2 = Gy.n_rows * m;
+
+  return KronOperator({KronTerm(In, Gx, 0, 0), KronTerm(Gy, Im, r1, 0)},
+                      r1 + r2, (m + 2) * (n + 2));
+}
+
+KronOperator KronOperator::gradient(u16 k, u32 m, u32 n, u32 o, Real dx,
+                                    Real dy, Real dz) {
+  Gradient Gx(k, m, dx);
+  Gradient Gy(k, n, dy);
+  Gradient Gz(k, o, dz);
+  sp_mat Im = shed_rows(m), In = shed_rows(n), Io = shed_rows(o);
+
+  const uword r1 = Gx.n_rows * n * o;
+  const uword r2 = Gy.n_rows * m * o;
+  const uword r3 = Gz.n_rows * m * n;
+
+  return KronOperator({KronTerm(Io, In, Gx, 0, 0),
+                       KronTerm(Io, Gy, Im, r1, 0),
+                       KronTerm(Gz, In, Im, r1 + r2, 0)},
+                      r1 + r2 + r3, (m + 2) * (n + 2) * (o + 2));
+}
+
+KronOperator KronOperator::divergence(u16 k, u32 m, u32 n, Real dx,
+                                      Real dy) {
+  Divergence Dx(k, m, dx);
+  Divergence Dy(k, n, dy);
+  sp_mat Im = shed_cols(m), In = shed_cols(n);
+
+  const uword c1 = Dx.n_cols * n;
+  const uword c2 = Dy.n_cols * m;
+
+  return KronOperator({KronTerm(In, Dx, 0, 0), KronTerm(Dy, Im, 0, c1)},
+                      (m + 2) * (n + 2), c1 + c2);
+}
+
+KronOperator KronOperator::divergence(u16 k, u32 m, u32 n, u32 o, Real dx,
+                                      Real dy, Real dz) {
+  Divergence Dx(k, m, dx);
+  Divergence Dy(k, n, dy);
+  Divergence Dz(k, o, dz);
+  sp_mat Im = shed_cols(m), In = shed_cols(n), Io = shed_cols(o);
+
+  const uword c1 = Dx.n_cols * n * o;
+  const uword c2 = Dy.n_cols * m * o;
+  const uword c3 = Dz.n_cols * m * n;
+
+  return KronOperator({KronTerm(Io, In, Dx, 0, 0),
+                       KronTerm(Io, Dy, Im, 0, c1),
+                       KronTerm(Dz, In, Im, 0, c1 + c2)},
+                      (m + 2) * (n + 2) * (o + 2), c1 + c2 + c3);
+}
+
+KronOperator KronOperator::laplacian(u16 k, u32 m, u32 n, Real dx, Real dy) {
+  Laplacian Lx(k, m, dx);
+  Laplacian Ly(k, n, dy);
+  sp_mat Im = interior(m), In = interior(n);
+
+  const uword N = (m + 2) * (n + 2);
+
+  return KronOperator({KronTerm(In, Lx), KronTerm(Ly, Im)}, N, N);
+}
+
+KronOperator KronOperator::laplacian(u16 k, u32 m, u32 n, u32 o, Real dx,
+                                     Real dy, Real dz) {
+  Laplacian Lx(k, m, dx);
+  Laplacian Ly(k, n, dy);
+  Laplacian Lz(k, o, dz);
+  sp_mat Im = interior(m), In = interior(n), Io = interior(o);
+
+  const uword N = (m + 2) * (n + 2) * (o + 2);
+
+  return KronOperator({KronTerm(Io, In, Lx), KronTerm(Io, Ly, Im),
+                       KronTerm(Lz, In, Im)},
+                      N, N);
+}
+
+// Entries of an output line updated together, 4 KB of doubles, so the block
+// stays in L1 while every nonzero of its row adds an input line to it
+static const uword line_block = 512;
+
+// out(:, i, o) = sum_c A(i, c) in(:, c, o), with lines of length inner
+static void contract(const std::vector<uword> &row_ptr,
+                     const std::vector<uword> &col_ind,
+                     const std::vector<Real> &val, uword rows, uword cols,
+                     const Real *in, Real *out, uword inner, uword outer) {
+  const uword blocks = (inner + line_block - 1) / line_block;
+
+#pragma omp parallel for collapse(3) schedule(static)
+  for (sword o = 0; o < static_cast<sword>(outer); ++o) {
+    for (sword i = 0; i < static_cast<sword>(rows); ++i) {
+      for (sword b = 0; b < static_cast<sword>(blocks); ++b) {
+        const uword begin = b * line_block;
+        const uword len = std::min(line_block, inner - begin);
+        Real *po = out + inner * (i + rows * o) + begin;
+        for (uword l = 0; l < len; ++l)
+          po[l] = 0.0;
+
+        for (uword p = row_ptr[i]; p < row_ptr[i + 1]; ++p) {
+          const Real v = val[p];
+          const Real *pi = in + inner * (col_ind[p] + cols * o) + begin;
+#pragma omp simd
+          for (uword l = 0; l < len; ++l)
+            po[l] += v * pi[l];
+        }
+      }
+    }
+  }
+}
+
+void KronOperator::apply(const vec &x, vec &y) const {
+  assert(x.n_elem == n_cols);
+  assert(&x != &y);
+
+  y.zeros(n_rows);
+
+  for (const Term &t : terms) {
+    const uword d = t.factors.size();
+
+    // Axis a is contracted by factor d - 1 - a
+    std::vector<uword> dims(d);
+    for (uword a = 0; a < d; ++a)
+      dims[a] = t.factors[d - 1 - a].n_cols;
+
+    const Real *in = x.memptr() + t.col_offset;
+    int next = 0;
+
+    for (uword a = 0; a < d; ++a) {
+      const Factor &f = t.factors[d - 1 - a];
+      if (f.identity)
+        continue;
+
+      uword inner = 1, outer = 1;
+      for (uword b = 0; b < a; ++b)
+        inner *= dims[b];
+      for (uword b = a + 1; b < d; ++b)
+        outer *= dims[b];
+
+      std::vector<Real> &out = buffer[next];
+      out.resize(inner * f.n_rows * outer);
+      contract(f.row_ptr, f.col_ind, f.val, f.n_rows, f.n_cols, in,
+               out.data(), inner, outer);
+
+      dims[a] = f.n_rows;
+      in = out.data();
+      next ^= 1;
+    }
+
+    uword len = 1;
+    for (uword a = 0; a < d; ++a)
+      len *= dims[a];
+
+    Real *py = y.memptr() + t.row_offset;
+#pragma omp parallel for schedule(static)
+    for (sword i = 0; i < static_cast<sword>(len); ++i)
+      py[i] += in[i];
+  }
+}
+
+vec KronOperator::operator*(const vec &x) const {
+  vec y;
+  apply(x, y);
+  return y;
+}
+
+// A from its rows, which are the columns of A^T
+static sp_mat to_sp_mat(uword n_rows, uword n_cols,
+                        const std::vector<uword> &row_ptr,
+                        const std::vector<uword> &col_ind,
+                        const std::vector<Real> &val) {
+  sp_mat At(uvec(col_ind), uvec(row_ptr), vec(val), n_cols, n_rows);
+  return At.t();
+}
+
+sp_mat KronOperator::assemble() const {
+  std::vector<std::vector<sp_mat>> factors;
+  for (const Term &t : terms) {
+    factors.emplace_back();
+    for (const Factor &f : t.factors)
+      factors.back().push_back(
+          to_sp_mat(f.n_rows, f.n_cols, f.row_ptr, f.col_ind, f.val));
+  }
+
+  std::vector<KronTerm> blocks;
+  for (size_t b = 0; b < terms.size(); ++b) {
+    const Term &t = terms[b];
+    const std::vector<sp_mat> &F = factors[b];
+    if (F.size() == 2)
+      blocks.emplace_back(F[0], F[1], t.row_offset, t.col_offset);
+    else
+      blocks.emplace_back(F[0], F[1], F[2], t.row_offset, t.col_offset);
+  }
+
+  return Utils::spkron_sum(blocks, n_rows, n_cols);
+}
+
+uword KronOperator::memory() const {
+  uword bytes = 0;
+  for (const Term &t : terms)
+    for (const Factor &f : t.factors)
+      bytes += (f.row_ptr.size() + f.col_ind.size()) * sizeof(uword) +
+               f.val.size() * sizeof(Real);
+  return bytes;
+}
@@ -0,0 +1,126 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file kronoperator.h
+ *
+ * @brief Unassembled sums of Kronecker products of 1-D operators
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef KRONOPERATOR_H
+#define KRONOPERATOR_H
+
+#include "utils.h"
+#include <vector>
+
+/**
+ * @brief Sum of Kronecker products kept as its 1-D factors
+ *
+ * Holds the same blocks Utils::spkron_sum() would assemble, but only stores
+ * the factors, so a 3-D operator takes O(m + n + o) memory instead of O(N).
+ * A block kron(C, B, A) is applied to the field seen as an (a, b, c) cube
+ * by contracting one axis at a time, A along the first, B along the second
+ * and C along the third, skipping identity factors. Every contraction
+ * combines contiguous lines or slabs of the cube, which keeps the inner
+ * loops unit-stride. Long slabs are cut into cache-sized blocks, so each
+ * output block stays in L1 while all the input slabs of its row are added
+ * into it, and the blocks are spread over OpenMP threads.
+ *
+ * @code
+ * KronOperator G = KronOperator::gradient(k, m, n, o, dx, dy, dz);
+ * vec g = G * f; // equals Gradient(k, m, n, o, dx, dy, dz) * f
+ * @endcode
+ */
+class KronOperator {
+
+public:
+  /**
+   * @brief Copies the factors of the blocks
+   *
+   * @param terms Blocks, as for Utils::spkron_sum()
+   * @param n_rows Rows of the whole operator
+   * @param n_cols Columns of the whole operator
+   */
+  KronOperator(const std::vector<KronTerm> &terms, uword n_rows,
+               uword n_cols);
+
+  /**
+   * @brief Factors of the 2-D and 3-D mimetic Gradient
+   */
+  static KronOperator gradient(u16 k, u32 m, u32 n, Real dx, Real dy);
+  static KronOperator gradient(u16 k, u32 m, u32 n, u32 o, Real dx, Real dy,
+                               Real dz);
+
+  /**
+   * @brief Factors of the 2-D and 3-D mimetic Divergence
+   */
+  static KronOperator divergence(u16 k, u32 m, u32 n, Real dx, Real dy);
+  static KronOperator divergence(u16 k, u32 m, u32 n, u32 o, Real dx, Real dy,
+                                 Real dz);
+
+  /**
+   * @brief Factors of the 2-D and 3-D mimetic Laplacian
+   *
+   * Divergence * Gradient is the Kronecker sum of the 1-D Laplacians with
+   * identities whose boundary entries are zero.
+   */
+  static KronOperator laplacian(u16 k, u32 m, u32 n, Real dx, Real dy);
+  static KronOperator laplacian(u16 k, u32 m, u32 n, u32 o, Real dx, Real dy,
+                                Real dz);
+
+  /**
+   * @brief y = A * x
+   *
+   * The intermediate cubes live in a workspace kept between calls, so
+   * repeated products do not allocate. For the same reason, one operator
+   * must not be applied from several threads at once.
+   *
+   * @param x Input vector with n_cols entries
+   * @param y Output vector, resized if needed; must not alias x
+   */
+  void apply(const vec &x, vec &y) const;
+
+  /**
+   * @brief y = A * x
+   */
+  vec operator*(const vec &x) const;
+
+  /**
+   * @brief The assembled sparse matrix
+   */
+  sp_mat assemble() const;
+
+  /**
+   * @brief Bytes held by the factors
+   *
+   * The workspace of apply(), up to two intermediate vectors of the size of
+   * the operator, is not counted.
+   */
+  uword memory() const;
+
+  uword n_rows, n_cols;
+
+private:
+  // A 1-D factor, stored by rows for the contractions
+  struct Factor {
+    uword n_rows, n_cols;
+    bool identity;
+    std::vector<uword> row_ptr, col_ind;
+    std::vector<Real> val;
+  };
+
+  struct Term {
+    std::vector<Factor> factors; // Outermost factor first
+    uword row_offset, col_offset;
+  };
+
+  std::vector<Term> terms;
+  mutable std::vector<Real> buffer[2];
+};
+
+#endif // KRONOPERATOR_H
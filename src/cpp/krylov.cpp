@@ -0,0 +1,468 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file krylov.cpp
+ *
+ * @brief Preconditioned Krylov solvers for mimetic systems
+ *
+ * @date 2024/10/15
+ */
+
+#include "krylov.h"
+#include "csrmatrix.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+// Row-wise copy of A, with the position of every diagonal entry
+static void to_rows(const sp_mat &A, std::vector<uword> &row_ptr,
+                    std::vector<uword> &col_ind, std::vector<uword> &diag,
+                    std::vector<Real> &val) {
+  assert(A.n_rows == A.n_cols);
+
+  // The columns of A^T are the rows of A
+  sp_mat At = A.t();
+  At.sync();
+
+  row_ptr.assign(At.col_ptrs, At.col_ptrs + At.n_cols + 1);
+  col_ind.assign(At.row_indices, At.row_indices + At.n_nonzero);
+  val.assign(At.values, At.values + At.n_nonzero);
+  diag.assign(A.n_rows, 0);
+
+  for (uword i = 0; i < A.n_rows; ++i) {
+    uword p = row_ptr[i];
+    while (p < row_ptr[i + 1] && col_ind[p] < i)
+      ++p;
+    if (p == row_ptr[i + 1] || col_ind[p] != i)
+      throw std::invalid_argument("Preconditioner needs a nonzero diagonal");
+    diag[i] = p;
+  }
+}
+
+JacobiPreconditioner::JacobiPreconditioner(const sp_mat &A) {
+  inv_diag = vec(A.diag());
+  for (uword i = 0; i < inv_diag.n_elem; ++i) {
+    if (inv_diag(i) == 0.0)
+      throw std::invalid_argument("Preconditioner needs a nonzero diagonal");
+    inv_diag(i) = 1.0 / inv_diag(i);
+  }
+}
+
+void JacobiPreconditioner::apply(const vec &r, vec &z) const {
+  z = inv_diag % r;
+}
+
+ILU0Preconditioner::ILU0Preconditioner(const sp_mat &A) {
+  to_rows(A, row_ptr, col_ind, diag, val);
+
+  const uword n = diag.size();
+  std::vector<sword> pos(n, -1);
+
+  for (uword i = 0; i < n; ++i) {
+    for (uword p = row_ptr[i]; p < row_ptr[i + 1]; ++p)
+      pos[col_ind[p]] = p;
+
+    // Eliminate with the rows above, keeping only entries of the pattern
+    for (uword p = row_ptr[i]; p < diag[i]; ++p) {
+      const uword k = col_ind[p];
+      val[p] /= val[diag[k]];
+      for (uword q = diag[k] + 1; q < row_ptr[k + 1]; ++q)
+        if (pos[col_ind[q]] >= 0)
+          val[pos[col_ind[q]]] -= val[p] * val[q];
+    }
+
+    for (uword p = row_ptr[i]; p < row_ptr[i + 1]; ++p)
+      pos[col_ind[p]] = -1;
+
+    if (val[diag[i]] == 0.0)
+      throw std::runtime_error("ILU(0) encountered a zero pivot");
+  }
+}
+
+void ILU0Preconditioner::apply(const vec &r, vec &z) const {
+  const uword n = diag.size();
+  assert(r.n_elem == n);
+
+  z = r;
+
+  // L y = r
+  for (uword i = 0; i < n; ++i) {
+    Real s = z(i);
+    for (uword p = row_ptr[i]; p < diag[i]; ++p)
+      s -= val[p] * z(col_ind[p]);
+    z(i) = s;
+  }
+
+  // U z = y
+  for (uword i = n; i-- > 0;) {
+    Real s = z(i);
+    for (uword p = diag[i] + 1; p < row_ptr[i + 1]; ++p)
+      s -= val[p] * z(col_ind[p]);
+    z(i) = s / val[diag[i]];
+  }
+}
+
+SSORPreconditioner::SSORPreconditioner(const sp_mat &A, Real omega)
+    : omega(omega) {
+  assert(omega > 0 && omega < 2);
+  to_rows(A, row_ptr, col_ind, diag, val);
+}
+
+// z = omega * (2 - omega) * (D + omega * U)^-1 * D * (D + omega * L)^-1 * r
+void SSORPreconditioner::apply(const vec &r, vec &z) const {
+  const uword n = diag.size();
+  assert(r.n_elem == n);
+
+  z = r;
+
+  for (uword i = 0; i < n; ++i) {
+    Real s = z(i);
+    for (uword p = row_ptr[i]; p < diag[i]; ++p)
+      s -= omega * val[p] * z(col_ind[p]);
+    z(i) = s / val[diag[i]];
+  }
+
+  for (uword i = 0; i < n; ++i)
+    z(i) *= val[diag[i]];
+
+  for (uword i = n; i-- > 0;) {
+    Real s = z(i);
+    for (uword p = diag[i] + 1; p < row_ptr[i + 1]; ++p)
+      s -= omega * val[p] * z(col_ind[p]);
+    z(i) = s / val[diag[i]];
+  }
+
+  z *= omega * (2.0 - omega);
+}
+
+// Action of an operator or preconditioner on vectors of eT; an empty
+// preconditioner is the identity
+template <typename eT>
+using Apply = std::function<void(const Col<eT> &x, Col<eT> &y)>;
+
+template <typename eT>
+static void precondition(const Apply<eT> &M, const Col<eT> &r, Col<eT> &z) {
+  if (M)
+    M(r, z);
+  else
+    z = r;
+}
+
+static Apply<Real> preconditioner(const Preconditioner *M) {
+  if (!M)
+    return Apply<Real>();
+  return [M](const vec &r, vec &z) { M->apply(r, z); };
+}
+
+// Converted once per solve, so every iteration runs row-parallel
+static LinearOperator wrap(const sp_mat &A) {
+  auto csr = std::make_shared<CSRMatrix>(A);
+  return [csr](const vec &x, vec &y) { csr->apply(x, y); };
+}
+
+// Initial guess, initial residual and target residual norm
+template <typename eT>
+static Real start(const Apply<eT> &A, const Col<eT> &b, Col<eT> &x,
+                  Col<eT> &r, const KrylovOptions &opts) {
+  if (x.n_elem != b.n_elem)
+    x.zeros(b.n_elem);
+
+  A(x, r);
+  r = b - r;
+
+  return std::max(opts.rtol * norm(b), opts.atol);
+}
+
+template <typename eT>
+static KrylovResult run_cg(const Apply<eT> &A, const Col<eT> &b, Col<eT> &x,
+                           const Apply<eT> &M, const KrylovOptions &opts) {
+  KrylovResult result;
+  Col<eT> r, z, p, Ap;
+
+  const Real tol = start(A, b, x, r, opts);
+  result.residual = norm(r);
+
+  precondition(M, r, z);
+  p = z;
+  eT rz = dot(r, z);
+
+  while (result.residual > tol && result.iterations < opts.max_iterations) {
+    A(p, Ap);
+    const eT alpha = rz / dot(p, Ap);
+    x += alpha * p;
+    r -= alpha * Ap;
+
+    result.residual = norm(r);
+    result.history.push_back(result.residual);
+    ++result.iterations;
+
+    precondition(M, r, z);
+    const eT rz_new = dot(r, z);
+    p = z + (rz_new / rz) * p;
+    rz = rz_new;
+  }
+
+  result.converged = result.residual <= tol;
+  return result;
+}
+
+template <typename eT>
+static KrylovResult run_bicgstab(const Apply<eT> &A, const Col<eT> &b,
+                                 Col<eT> &x, const Apply<eT> &M,
+                                 const KrylovOptions &opts) {
+  KrylovResult result;
+  Col<eT> r, p, v, s, t, p_hat, s_hat;
+
+  const Real tol = start(A, b, x, r, opts);
+  result.residual = norm(r);
+
+  const Col<eT> r0 = r;
+  eT rho = 1, alpha = 1, omega = 1;
+  p.zeros(b.n_elem);
+  v.zeros(b.n_elem);
+
+  while (result.residual > tol && result.iterations < opts.max_iterations) {
+    const eT rho_new = dot(r0, r);
+    if (rho_new == 0.0)
+      break; // Breakdown, restarting would need a new shadow residual
+
+    p = r + (rho_new / rho) * (alpha / omega) * (p - omega * v);
+    precondition(M, p, p_hat);
+    A(p_hat, v);
+    alpha = rho_new / dot(r0, v);
+    s = r - alpha * v;
+
+    ++result.iterations;
+
+    if (norm(s) <= tol) {
+      x += alpha * p_hat;
+      result.residual = norm(s);
+      result.history.push_back(result.residual);
+      break;
+    }
+
+    precondition(M, s, s_hat);
+    A(s_hat, t);
+    omega = dot(t, s) / dot(t, t);
+    x += alpha * p_hat + omega * s_hat;
+    r = s - omega * t;
+    rho = rho_new;
+
+    result.residual = norm(r);
+    result.history.push_back(result.residual);
+
+    if (omega == 0.0)
+      break;
+  }
+
+  result.converged = result.residual <= tol;
+  return result;
+}
+
+template <typename eT>
+static KrylovResult run_gmres(const Apply<eT> &A, const Col<eT> &b,
+                              Col<eT> &x, const Apply<eT> &M,
+                              const KrylovOptions &opts) {
+  assert(opts.restart > 0);
+
+  KrylovResult result;
+  Col<eT> r, w, z;
+
+  const Real tol = start(A, b, x, r, opts);
+  const uword m = opts.restart;
+  result.residual = norm(r);
+
+  std::vector<Col<eT>> V(m + 1);
+  Mat<eT> H(m + 1, m);
+  Col<eT> cs(m), sn(m), g(m + 1), y;
+
+  bool breakdown = false;
+  while (!breakdown && result.residual > tol &&
+         result.iterations < opts.max_iterations) {
+    H.zeros();
+    g.zeros();
+    g(0) = result.residual;
+    V[0] = r / result.residual;
+
+    // Arnoldi with modified Gram-Schmidt, H kept triangular by Givens
+    uword k = 0;
+    while (k < m && result.iterations < opts.max_iterations) {
+      precondition(M, V[k], z);
+      A(z, w);
+
+      for (uword i = 0; i <= k; ++i) {
+        H(i, k) = dot(w, V[i]);
+        w -= H(i, k) * V[i];
+      }
+      H(k + 1, k) = norm(w);
+      if (H(k + 1, k) > 0.0)
+        V[k + 1] = w / H(k + 1, k);
+
+      for (uword i = 0; i < k; ++i) {
+        const eT h = cs(i) * H(i, k) + sn(i) * H(i + 1, k);
+        H(i + 1, k) = -sn(i) * H(i, k) + cs(i) * H(i + 1, k);
+        H(i, k) = h;
+      }
+
+      // A zero column: the Krylov space stopped growing without reaching
+      // b, as for a singular A, so the cycle ends with the columns so far
+      const eT d = std::hypot(H(k, k), H(k + 1, k));
+      if (d == 0.0) {
+        breakdown = true;
+        break;
+      }
+      cs(k) = H(k, k) / d;
+      sn(k) = H(k + 1, k) / d;
+      H(k, k) = d;
+      H(k + 1, k) = 0.0;
+      g(k + 1) = -sn(k) * g(k);
+      g(k) = cs(k) * g(k);
+
+      ++k;
+      ++result.iterations;
+      result.residual = std::abs(g(k));
+      result.history.push_back(result.residual);
+
+      if (result.residual <= tol || sn(k - 1) == 0.0)
+        break;
+    }
+
+    // x += M^-1 * V * y, with H(0:k-1, 0:k-1) * y = g(0:k-1)
+    y.zeros(k);
+    for (uword i = k; i-- > 0;) {
+      eT s = g(i);
+      for (uword j = i + 1; j < k; ++j)
+        s -= H(i, j) * y(j);
+      y(i) = s / H(i, i);
+    }
+
+    w.zeros(b.n_elem);
+    for (uword i = 0; i < k; ++i)
+      w += y(i) * V[i];
+    precondition(M, w, z);
+    x += z;
+
+    // Restart from the true residual
+    A(x, r);
+    r = b - r;
+    result.residual = norm(r);
+  }
+
+  result.converged = result.residual <= tol;
+  return result;
+}
+
+KrylovResult Krylov::cg(const LinearOperator &A, const vec &b, vec &x,
+                        const Preconditioner *M, const KrylovOptions &opts) {
+  return run_cg<Real>(A, b, x, preconditioner(M), opts);
+}
+
+KrylovResult Krylov::bicgstab(const LinearOperator &A, const vec &b, vec &x,
+                              const Preconditioner *M,
+                              const KrylovOptions &opts) {
+  return run_bicgstab<Real>(A, b, x, preconditioner(M), opts);
+}
+
+KrylovResult Krylov::gmres(const LinearOperator &A, const vec &b, vec &x,
+                           const Preconditioner *M,
+                           const KrylovOptions &opts) {
+  return run_gmres<Real>(A, b, x, preconditioner(M), opts);
+}
+
+KrylovResult Krylov::cg(const sp_mat &A, const vec &b, vec &x,
+                        const Preconditioner *M, const KrylovOptions &opts) {
+  return cg(wrap(A), b, x, M, opts);
+}
+
+KrylovResult Krylov::bicgstab(const sp_mat &A, const vec &b, vec &x,
+                              const Preconditioner *M,
+                              const KrylovOptions &opts) {
+  return bicgstab(wrap(A), b, x, M, opts);
+}
+
+KrylovResult Krylov::gmres(const sp_mat &A, const vec &b, vec &x,
+                           const Preconditioner *M,
+                           const KrylovOptions &opts) {
+  return gmres(wrap(A), b, x, M, opts);
+}
+
+// to = from, converted element by element into to's existing memory
+template <typename S, typename T>
+static void convert(const Col<S> &from, Col<T> &to) {
+  to.set_size(from.n_elem);
+  std::copy(from.begin(), from.end(), to.begin());
+}
+
+KrylovResult Krylov::refine(const sp_mat &A, const vec &b, vec &x,
+                            KrylovMethod method, const Preconditioner *M,
+                            const KrylovOptions &opts) {
+  const CSRMatrix Ad(A);
+  const fCSRMatrix Af(A);
+
+  const LinearOperator op = [&Ad](const vec &x, vec &y) { Ad.apply(x, y); };
+  const Apply<float> op_f = [&Af](const fvec &x, fvec &y) {
+    Af.apply(x, y);
+  };
+
+  // The preconditioner stays in float64, only its input and output convert,
+  // through buffers kept for the whole solve
+  vec r_d, z_d;
+  Apply<float> M_f;
+  if (M)
+    M_f = [M, &r_d, &z_d](const fvec &r, fvec &z) {
+      convert(r, r_d);
+      M->apply(r_d, z_d);
+      convert(z_d, z);
+    };
+
+  KrylovResult result;
+  vec r;
+  fvec r_f, d;
+
+  const Real tol = start(op, b, x, r, opts);
+  result.residual = norm(r);
+
+  while (result.residual > tol && result.iterations < opts.max_iterations) {
+    KrylovOptions inner = opts;
+    inner.rtol = opts.inner_rtol;
+    inner.atol = 0.0;
+    inner.max_iterations = opts.max_iterations - result.iterations;
+
+    // Correction A * d = r, from a zero initial guess
+    convert(r, r_f);
+    d.reset();
+
+    KrylovResult c;
+    switch (method) {
+    case KrylovMethod::CG:
+      c = run_cg<float>(op_f, r_f, d, M_f, inner);
+      break;
+    case KrylovMethod::BiCGSTAB:
+      c = run_bicgstab<float>(op_f, r_f, d, M_f, inner);
+      break;
+    case KrylovMethod::GMRES:
+      c = run_gmres<float>(op_f, r_f, d, M_f, inner);
+      break;
+    }
+
+    if (c.iterations == 0)
+      break;
+    result.iterations += c.iterations;
+
+    for (uword i = 0; i < x.n_elem; ++i)
+      x(i) += d(i);
+    op(x, r);
+    r = b - r;
+    result.residual = norm(r);
+    result.history.push_back(result.residual);
+  }
+
+  result.converged = result.residual <= tol;
+  return result;
+}
@@ -0,0 +1,209 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file krylov.h
+ *
+ * @brief Preconditioned Krylov solvers for mimetic systems
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef KRYLOV_H
+#define KRYLOV_H
+
+#include "utils.h"
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Action of a linear operator, y = A * x
+ *
+ * Lets the solvers work on matrix-free operators, e.g.
+ * [&L](const vec &x, vec &y) { L.apply(x, y); }
+ */
+typedef std::function<void(const vec &x, vec &y)> LinearOperator;
+
+/**
+ * @brief Approximate inverse applied by the Krylov solvers, z = M^-1 * r
+ */
+class Preconditioner {
+public:
+  virtual ~Preconditioner() {}
+
+  /**
+   * @brief z = M^-1 * r
+   *
+   * @param r Residual
+   * @param z Preconditioned residual, resized if needed
+   */
+  virtual void apply(const vec &r, vec &z) const = 0;
+};
+
+/**
+ * @brief Diagonal (Jacobi) preconditioner
+ */
+class JacobiPreconditioner : public Preconditioner {
+public:
+  /**
+   * @param A Sparse matrix with a nonzero diagonal
+   */
+  explicit JacobiPreconditioner(const sp_mat &A);
+
+  void apply(const vec &r, vec &z) const override;
+
+private:
+  vec inv_diag;
+};
+
+/**
+ * @brief Incomplete LU factorization with the sparsity pattern of A
+ */
+class ILU0Preconditioner : public Preconditioner {
+public:
+  /**
+   * @param A Square sparse matrix with a nonzero diagonal
+   */
+  explicit ILU0Preconditioner(const sp_mat &A);
+
+  void apply(const vec &r, vec &z) const override;
+
+private:
+  // L (unit diagonal) and U stored together by rows
+  std::vector<uword> row_ptr, col_ind, diag;
+  std::vector<Real> val;
+};
+
+/**
+ * @brief Symmetric successive over-relaxation preconditioner
+ */
+class SSORPreconditioner : public Preconditioner {
+public:
+  /**
+   * @param A Square sparse matrix with a nonzero diagonal
+   * @param omega Relaxation factor, 0 < omega < 2
+   */
+  SSORPreconditioner(const sp_mat &A, Real omega = 1.0);
+
+  void apply(const vec &r, vec &z) const override;
+
+private:
+  std::vector<uword> row_ptr, col_ind, diag;
+  std::vector<Real> val;
+  Real omega;
+};
+
+/**
+ * @brief Stopping criteria of the Krylov solvers
+ *
+ * A solve stops once ||b - A * x|| <= max(rtol * ||b||, atol).
+ */
+struct KrylovOptions {
+  Real rtol = 1e-8;           ///< Relative tolerance
+  Real atol = 0.0;            ///< Absolute tolerance
+  uword max_iterations = 1000; ///< Iteration limit
+  uword restart = 50;         ///< Krylov subspace size of GMRES
+  Real inner_rtol = 1e-4;     ///< Relative tolerance of refine corrections
+};
+
+/**
+ * @brief Krylov method used by the corrections of Krylov::refine
+ */
+enum class KrylovMethod { CG, BiCGSTAB, GMRES };
+
+/**
+ * @brief Outcome of a Krylov solve
+ */
+struct KrylovResult {
+  bool converged = false;
+  uword iterations = 0;       ///< Iterations performed
+  Real residual = 0.0;        ///< Final residual norm
+  std::vector<Real> history;  ///< Residual norm after every iteration
+};
+
+/**
+ * @brief Preconditioned Krylov solvers
+ *
+ * Each solver uses x as the initial guess when it already has the size of
+ * b, which allows warm starts from a previous solution, and zero otherwise.
+ * Preconditioning is applied from the right in BiCGSTAB and GMRES, so the
+ * reported residuals are those of the original system. The sp_mat overloads
+ * copy A into a CSRMatrix once and run its products on all threads.
+ */
+class Krylov {
+public:
+  /**
+   * @brief Conjugate gradients, for symmetric positive definite systems
+   *
+   * @param A Operator
+   * @param b Right-hand side
+   * @param x Initial guess on entry, solution on exit
+   * @param M Optional symmetric positive definite preconditioner
+   * @param opts Stopping criteria
+   */
+  static KrylovResult cg(const LinearOperator &A, const vec &b, vec &x,
+                         const Preconditioner *M = nullptr,
+                         const KrylovOptions &opts = KrylovOptions());
+  static KrylovResult cg(const sp_mat &A, const vec &b, vec &x,
+                         const Preconditioner *M = nullptr,
+                         const KrylovOptions &opts = KrylovOptions());
+
+  /**
+   * @brief Stabilized bi-conjugate gradients, for general systems
+   *
+   * @param A Operator
+   * @param b Right-hand side
+   * @param x Initial guess on entry, solution on exit
+   * @param M Optional preconditioner
+   * @param opts Stopping criteria
+   */
+  static KrylovResult bicgstab(const LinearOperator &A, const vec &b, vec &x,
+                               const Preconditioner *M = nullptr,
+                               const KrylovOptions &opts = KrylovOptions());
+  static KrylovResult bicgstab(const sp_mat &A, const vec &b, vec &x,
+                               const Preconditioner *M = nullptr,
+                               const KrylovOptions &opts = KrylovOptions());
+
+  /**
+   * @brief Restarted GMRES, for general systems
+   *
+   * @param A Operator
+   * @param b Right-hand side
+   * @param x Initial guess on entry, solution on exit
+   * @param M Optional preconditioner
+   * @param opts Stopping criteria and restart length
+   */
+  static KrylovResult gmres(const LinearOperator &A, const vec &b, vec &x,
+                            const Preconditioner *M = nullptr,
+                            const KrylovOptions &opts = KrylovOptions());
+  static KrylovResult gmres(const sp_mat &A, const vec &b, vec &x,
+                            const Preconditioner *M = nullptr,
+                            const KrylovOptions &opts = KrylovOptions());
+
+  /**
+   * @brief Mixed-precision solve by iterative refinement
+   *
+   * A is copied once to float32, and each correction A * d = r is solved
+   * with float32 vectors to opts.inner_rtol. The residual r = b - A * x and
+   * the update x += d are computed in float64, so the solution reaches
+   * opts.rtol as long as A is well enough conditioned for float32. The
+   * preconditioner, if any, stays in float64. iterations counts the inner
+   * iterations, history holds the residual after every correction.
+   *
+   * @param A Operator
+   * @param b Right-hand side
+   * @param x Initial guess on entry, solution on exit
+   * @param method Krylov method of the corrections
+   * @param M Optional preconditioner
+   * @param opts Stopping criteria
+   */
+  static KrylovResult refine(const sp_mat &A, const vec &b, vec &x,
+                             KrylovMethod method = KrylovMethod::GMRES,
+                             const Preconditioner *M = nullptr,
+                             const KrylovOptions &opts = KrylovOptions());
+};
+
+#endif // KRYLOV_H
@@ -17,29 +17,120 @@
 
 #include "laplacian.h"
 
+// Interior stencil of the 1-D Laplacian, the convolution of the divergence
+// and gradient stencils
+static std::vector<Real> interior_stencil(u16 k, Real dx) {
+  const std::vector<Real> w = Stencil::interior(k);
+  std::vector<Real> out(2 * w.size() - 1, 0.0);
+
+  for (size_t i = 0; i < w.size(); ++i)
+    for (size_t j = 0; j < w.size(); ++j)
+      out[i + j] += w[i] * w[j] / (dx * dx);
+
+  return out;
+}
+
 // 1-D Constructor
 Laplacian::Laplacian(u16 k, u32 m, Real dx) {
   Divergence div(k, m, dx);
   Gradient grad(k, m, dx);
 
   // Dimensions = m+2, m+2
-  *this = (sp_mat)div * (sp_mat)grad;
+  *this = static_cast<const sp_mat &>(div) * static_cast<const sp_mat &>(grad);
+
+  kernels.push_back(Stencil(*this, interior_stencil(k, dx), 1 - k, k));
+  assembled_nnz = n_nonzero;
+}
+
+// Identity of size c+2 with zero corners: the product of the identities
+// with shed columns and shed rows of the 2-D/3-D Divergence and Gradient
+static sp_mat interior_identity(u32 c) {
+  sp_mat I = speye(c + 2, c + 2);
+  I.at(0, 0) = 0;
+  I.at(c + 1, c + 1) = 0;
+  return I;
 }
 
 // 2-D Constructor
+//
+// D * G = kron(In, Dx * Gx) + kron(Dy * Gy, Im) with corner-free In and Im,
+// so only the 1-D products are formed
 Laplacian::Laplacian(u16 k, u32 m, u32 n, Real dx, Real dy) {
-  Divergence div(k, m, n, dx, dy);
-  Gradient grad(k, m, n, dx, dy);
+  Laplacian Lx(k, m, dx);
+  Laplacian Ly(k, n, dy);
+
+  sp_mat Im = interior_identity(m);
+  sp_mat In = interior_identity(n);
 
   // Dimensions = (m+2)*(n+2), (m+2)*(n+2)
-  *this = (sp_mat)div * (sp_mat)grad;
+  const uword N = (m + 2) * (n + 2);
+
+  *this = Utils::spkron_sum({KronTerm(In, Lx), KronTerm(Ly, Im)}, N, N);
+
+  kernels = {Lx.kernels[0], Ly.kernels[0]};
+  assembled_nnz = n_nonzero;
 }
 
 // 3-D Constructor
 Laplacian::Laplacian(u16 k, u32 m, u32 n, u32 o, Real dx, Real dy, Real dz) {
-  Divergence div(k, m, n, o, dx, dy, dz);
-  Gradient grad(k, m, n, o, dx, dy, dz);
+  Laplacian Lx(k, m, dx);
+  Laplacian Ly(k, n, dy);
+  Laplacian Lz(k, o, dz);
+
+  sp_mat Im = interior_identity(m);
+  sp_mat In = interior_identity(n);
+  sp_mat Io = interior_identity(o);
 
   // Dimensions = (m+2)*(n+2)*(o+2), (m+2)*(n+2)*(o+2)
-  *this = (sp_mat)div * (sp_mat)grad;
+  const uword N = (m + 2) * (n + 2) * (o + 2);
+
+  *this = Utils::spkron_sum(
+      {KronTerm(Io, In, Lx), KronTerm(Io, Ly, Im), KronTerm(Lz, In, Im)}, N,
+      N);
+
+  kernels = {Lx.kernels[0], Ly.kernels[0], Lz.kernels[0]};
+  assembled_nnz = n_nonzero;
+}
+
+// Matrix-free application
+//
+// The 2-D and 3-D Laplacians are sums of 1-D Laplacians acting along each
+// axis on the lines of interior cells, so only those lines are visited.
+void Laplacian::apply(const vec &x, vec &y) const {
+  assert(x.n_elem == n_cols);
+
+  if (!matrix_free()) {
+    y = static_cast<const sp_mat &>(*this) * x;
+    return;
+  }
+
+  y.zeros(n_rows);
+  const Real *px = x.memptr();
+  Real *py = y.memptr();
+
+  if (kernels.size() == 1) {
+    kernels[0].apply(px, 1, py, 1, 1, false);
+  } else if (kernels.size() == 2) {
+    const uword m = kernels[0].n_rows - 2;
+    const uword n = kernels[1].n_rows - 2;
+
+    for (uword j = 1; j <= n; ++j)
+      kernels[0].apply(px + j * (m + 2), 1, py + j * (m + 2), 1, 1, true);
+    kernels[1].apply(px + 1, m + 2, py + 1, m + 2, m, true);
+  } else {
+    const uword m = kernels[0].n_rows - 2;
+    const uword n = kernels[1].n_rows - 2;
+    const uword o = kernels[2].n_rows - 2;
+    const uword mn = (m + 2) * (n + 2);
+
+    for (uword l = 1; l <= o; ++l)
+      for (uword j = 1; j <= n; ++j)
+        kernels[0].apply(px + l * mn + j * (m + 2), 1, py + l * mn + j * (m + 2),
+                         1, 1, true);
+    for (uword l = 1; l <= o; ++l)
+      kernels[1].apply(px + l * mn + 1, m + 2, py + l * mn + 1, m + 2, m, true);
+    for (uword j = 1; j <= n; ++j)
+      kernels[2].apply(px + j * (m + 2) + 1, mn, py + j * (m + 2) + 1, mn, m,
+                       true);
+  }
 }
@@ -22,10 +22,10 @@
  * @brief Mimetic Laplacian operator
  *
  */
-class Laplacian : public sp_mat {
+class Laplacian : public StencilOperator<Laplacian> {
 
 public:
-  using sp_mat::operator=;
+  using StencilOperator<Laplacian>::operator=;
 
   /**
    * @brief 1-D Mimetic Laplacian Constructor
@@ -60,6 +60,19 @@ public:
    * @param dz Spacing between cells in z-direction
    */  
   Laplacian(u16 k, u32 m, u32 n, u32 o, Real dx, Real dy, Real dz);
+
+  /**
+   * @brief Matrix-free application, y = L * x
+   *
+   * Applies the interior stencil of the 1-D Laplacian along each axis and
+   * uses the assembled rows only near the boundaries. Falls back to the
+   * sparse product once the matrix is assigned or modified, e.g. by adding a
+   * boundary operator; see StencilOperator for element writes.
+   *
+   * @param x Scalar field at centers and boundaries
+   * @param y Scalar field at centers and boundaries, resized if needed
+   */
+  void apply(const vec &x, vec &y) const;
 };
 
 #endif // LAPLACIAN_H
@@ -13,74 +13,103 @@
  */
 
 #include "mixedbc.h"
+#include "boundarypatch.h"
+#include "coefficients.h"
+#include <cassert>
+#include <stdexcept>
+
+namespace {
+
+// a * u + b * du/dn in the first and last rows of an (m+2) x (m+2) matrix
+sp_mat boundary_rows(u16 k, u32 m, Real dx, const FaceBC &left,
+                     const FaceBC &right) {
+  assert(!(k % 2));
+  assert(k > 1 && k < 9);
+  assert(m >= 2 * k);
+
+  // The outward derivative is -G(0, :) on the left and G(m, :) on the right,
+  // G(m, m + 1 - j) = -G(0, j)
+  const Real *g = Coefficients::gradient_row(k);
+
+  Triplets T(m + 2, m + 2, 2 * (k + 2));
+
+  if (left.a != 0.0)
+    T.at(0, 0) = left.a;
+  if (left.b != 0.0)
+    for (u32 j = 0; j <= k; ++j)
+      T.at(0, j) = -left.b * (g[j] / dx);
+
+  if (right.a != 0.0)
+    T.at(m + 1, m + 1) = right.a;
+  if (right.b != 0.0)
+    for (u32 j = 0; j <= k; ++j)
+      T.at(m + 1, m + 1 - j) = -right.b * (g[j] / dx);
+
+  return T.assemble();
+}
+
+} // namespace
+
+FaceBC FaceBC::parse(const std::string &type,
+                     const std::vector<Real> &coeffs) {
+  const size_t needed = type == "Robin" ? 2 : 1;
+  if (coeffs.size() < needed)
+    throw std::invalid_argument("Missing boundary condition coefficients");
+
+  if (type == "Dirichlet")
+    return dirichlet(coeffs[0]);
+  if (type == "Neumann")
+    return neumann(coeffs[0]);
+  if (type == "Robin")
+    return robin(coeffs[0], coeffs[1]);
+
+  throw std::invalid_argument("Unknown boundary condition type");
+}
 
 // 1-D Constructor
+MixedBC::MixedBC(u16 k, u32 m, Real dx, const FaceBC &left,
+                 const FaceBC &right) {
+  *this = boundary_rows(k, m, dx, left, right);
+}
+
 MixedBC::MixedBC(u16 k, u32 m, Real dx, const std::string &left,
                  const std::vector<Real> &coeffs_left, const std::string &right,
-                 const std::vector<Real> &coeffs_right) {
-  sp_mat A(m + 2, m + 2);
-  sp_mat BG(m + 2, m + 2);
-
-  Gradient *grad = nullptr;
-
-  // Handle the left boundary condition
-  if (left == "Dirichlet") {
-    A.at(0, 0) = coeffs_left[0];
-  } else if (left == "Neumann") {
-    grad = new Gradient(k, m, dx);
-    BG.row(0) = -coeffs_left[0] * grad->row(0);
-  } else if (left == "Robin") {
-    A.at(0, 0) = coeffs_left[0];
-    grad = new Gradient(k, m, dx);
-    BG.row(0) = -coeffs_left[1] * grad->row(0);
-  } else {
-    throw std::invalid_argument("Unknown boundary condition type");
-  }
-
-  // Handle the right boundary condition
-  if (right == "Dirichlet") {
-    A.at(m + 1, m + 1) = coeffs_right[0];
-  } else if (right == "Neumann") {
-    if (!grad)
-      grad = new Gradient(k, m, dx);
-    BG.row(m + 1) = coeffs_right[0] * grad->row(m);
-  } else if (right == "Robin") {
-    A.at(m + 1, m + 1) = coeffs_right[0];
-    if (!grad)
-      grad = new Gradient(k, m, dx);
-    BG.row(m + 1) = coeffs_right[1] * grad->row(m);
-  } else {
-    throw std::invalid_argument("Unknown boundary condition type");
-  }
-
-  *this = A + BG;
-
-  delete grad;
-}
+                 const std::vector<Real> &coeffs_right)
+    : MixedBC(k, m, dx, FaceBC::parse(left, coeffs_left),
+              FaceBC::parse(right, coeffs_right)) {}
 
 // 2-D Constructor
-MixedBC::MixedBC(u16 k, u32 m, Real dx, u32 n, Real dy, const std::string &left,
-                 const std::vector<Real> &coeffs_left, const std::string &right,
+MixedBC::MixedBC(u16 k, u32 m, Real dx, u32 n, Real dy, const FaceBC &left,
+                 const FaceBC &right, const FaceBC &bottom,
+                 const FaceBC &top) {
+  *this = BoundaryPatch(boundary_rows(k, m, dx, left, right),
+                        boundary_rows(k, n, dy, bottom, top))
+              .assemble();
+}
+
+MixedBC::MixedBC(u16 k, u32 m, Real dx, u32 n, Real dy,
+                 const std::string &left, const std::vector<Real> &coeffs_left,
+                 const std::string &right,
                  const std::vector<Real> &coeffs_right,
                  const std::string &bottom,
                  const std::vector<Real> &coeffs_bottom, const std::string &top,
-                 const std::vector<Real> &coeffs_top) {
-  MixedBC Bm(k, m, dx, left, coeffs_left, right, coeffs_right);
-  MixedBC Bn(k, n, dy, bottom, coeffs_bottom, top, coeffs_top);
-
-  sp_mat Im = speye(m + 2, m + 2);
-  sp_mat In = speye(n + 2, n + 2);
-
-  In.at(0, 0) = 0;
-  In.at(n + 1, n + 1) = 0;
-
-  sp_mat BC1 = Utils::spkron(In, Bm);
-  sp_mat BC2 = Utils::spkron(Bn, Im);
+                 const std::vector<Real> &coeffs_top)
+    : MixedBC(k, m, dx, n, dy, FaceBC::parse(left, coeffs_left),
+              FaceBC::parse(right, coeffs_right),
+              FaceBC::parse(bottom, coeffs_bottom),
+              FaceBC::parse(top, coeffs_top)) {}
 
-  *this = BC1 + BC2;
+// 3-D Constructor
+MixedBC::MixedBC(u16 k, u32 m, Real dx, u32 n, Real dy, u32 o, Real dz,
+                 const FaceBC &left, const FaceBC &right,
+                 const FaceBC &bottom, const FaceBC &top,
+                 const FaceBC &front, const FaceBC &back) {
+  *this = BoundaryPatch(boundary_rows(k, m, dx, left, right),
+                        boundary_rows(k, n, dy, bottom, top),
+                        boundary_rows(k, o, dz, front, back))
+              .assemble();
 }
 
-// 3-D Constructor
 MixedBC::MixedBC(u16 k, u32 m, Real dx, u32 n, Real dy, u32 o, Real dz,
                  const std::string &left, const std::vector<Real> &coeffs_left,
                  const std::string &right,
@@ -89,25 +118,9 @@ MixedBC::MixedBC(u16 k, u32 m, Real dx, u32 n, Real dy, u32 o, Real dz,
                  const std::vector<Real> &coeffs_bottom, const std::string &top,
                  const std::vector<Real> &coeffs_top, const std::string &front,
                  const std::vector<Real> &coeffs_front, const std::string &back,
-                 const std::vector<Real> &coeffs_back) {
-  MixedBC Bm(k, m, dx, left, coeffs_left, right, coeffs_right);
-  MixedBC Bn(k, n, dy, bottom, coeffs_bottom, top, coeffs_top);
-  MixedBC Bo(k, o, dz, front, coeffs_front, back, coeffs_back);
-
-  sp_mat Im = speye(m + 2, m + 2);
-  sp_mat In = speye(n + 2, n + 2);
-  sp_mat Io = speye(o + 2, o + 2);
-
-  Io.at(0, 0) = 0;
-  Io.at(o + 1, o + 1) = 0;
-
-  sp_mat In2 = In;
-  In2.at(0, 0) = 0;
-  In2.at(n + 1, n + 1) = 0;
-
-  sp_mat BC1 = Utils::spkron(Utils::spkron(Io, In2), Bm);
-  sp_mat BC2 = Utils::spkron(Utils::spkron(Io, Bn), Im);
-  sp_mat BC3 = Utils::spkron(Utils::spkron(Bo, In), Im);
-
-  *this = BC1 + BC2 + BC3;
-}
+                 const std::vector<Real> &coeffs_back)
+    : MixedBC(k, m, dx, n, dy, o, dz, FaceBC::parse(left, coeffs_left),
+              FaceBC::parse(right, coeffs_right),
+              FaceBC::parse(bottom, coeffs_bottom),
+              FaceBC::parse(top, coeffs_top), FaceBC::parse(front, coeffs_front),
+              FaceBC::parse(back, coeffs_back)) {}
@@ -18,17 +18,81 @@
 #ifndef MIXEDBC_H
 #define MIXEDBC_H
 
-#include "gradient.h"
+#include "utils.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief Kind of boundary condition on one face
+ */
+enum class BCType { Dirichlet, Neumann, Robin };
+
+/**
+ * @brief Boundary condition of one face, a * u + b * du/dn
+ *
+ * @code
+ * MixedBC BC(k, m, dx, FaceBC::dirichlet(1), FaceBC::robin(1, 2));
+ * @endcode
+ */
+struct FaceBC {
+  BCType type;
+  Real a; ///< Coefficient of the Dirichlet term
+  Real b; ///< Coefficient of the Neumann term
+
+  static constexpr FaceBC dirichlet(Real a) {
+    return {BCType::Dirichlet, a, 0.0};
+  }
+
+  static constexpr FaceBC neumann(Real b) { return {BCType::Neumann, 0.0, b}; }
+
+  static constexpr FaceBC robin(Real a, Real b) {
+    return {BCType::Robin, a, b};
+  }
+
+  /**
+   * @brief Descriptor of the string form used by the MixedBC constructors
+   *
+   * @param type 'Dirichlet', 'Neumann' or 'Robin'
+   * @param coeffs One coefficient, or (a, b) for 'Robin'
+   */
+  static FaceBC parse(const std::string &type, const std::vector<Real> &coeffs);
+};
 
 /**
  * @brief Mimetic Mixed Boundary Condition operator
  *
+ * The boundary rows are written from the gradient's boundary stencil in
+ * Coefficients, so no Gradient is built.
  */
 class MixedBC : public sp_mat {
 
 public:
   using sp_mat::operator=;
 
+  /**
+   * @brief 1-D Constructor
+   *
+   * @param k Order of accuracy
+   * @param m Number of cells
+   * @param dx Spacing between cells
+   * @param left Boundary condition at the left boundary
+   * @param right Boundary condition at the right boundary
+   */
+  MixedBC(u16 k, u32 m, Real dx, const FaceBC &left, const FaceBC &right);
+
+  /**
+   * @brief 2-D Constructor, faces left, right, bottom and top
+   */
+  MixedBC(u16 k, u32 m, Real dx, u32 n, Real dy, const FaceBC &left,
+          const FaceBC &right, const FaceBC &bottom, const FaceBC &top);
+
+  /**
+   * @brief 3-D Constructor, faces left, right, bottom, top, front and back
+   */
+  MixedBC(u16 k, u32 m, Real dx, u32 n, Real dy, u32 o, Real dz,
+          const FaceBC &left, const FaceBC &right, const FaceBC &bottom,
+          const FaceBC &top, const FaceBC &front, const FaceBC &back);
+
   /**
    * @brief 1-D Constructor
    *
@@ -16,13 +16,35 @@
 #ifndef MOLE_H
 #define MOLE_H
 
+#include "boundarypatch.h"
+#include "coefficients.h"
+#include "complexoperators.h"
+#include "csrmatrix.h"
+#include "diamatrix.h"
 #include "divergence.h"
+#include "expression.h"
+#include "fastpoisson.h"
+#include "fft.h"
 #include "gradient.h"
 #include "interpol.h"
+#include "kronoperator.h"
+#include "krylov.h"
 #include "laplacian.h"
 #include "mixedbc.h"
+#include "multigrid.h"
+#include "operatorcache.h"
 #include "operators.h"
+#include "operatorstore.h"
+#include "parametricbc.h"
 #include "robinbc.h"
+#include "schrodinger.h"
+#include "sparsesolver.h"
+#include "stencil.h"
+#include "timeintegrator.h"
 #include "utils.h"
 
+#ifdef EIGEN
+#include "eigenbridge.h"
+#endif
+
 #endif // MOLE_H
@@ -0,0 +1,250 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file multigrid.cpp
+ *
+ * @brief Geometric multigrid for mimetic Laplacians on staggered grids
+ *
+ * @date 2024/10/15
+ */
+
+#include "multigrid.h"
+#include "boundarypatch.h"
+#include "laplacian.h"
+#include <cassert>
+#include <stdexcept>
+
+// Averages the two fine cells of every coarse cell, injects boundary nodes
+static sp_mat restriction(u32 mc) {
+  const u32 mf = 2 * mc;
+  Triplets T(mc + 2, mf + 2, mf + 2);
+
+  T.at(0, 0) = 1.0;
+  T.at(mc + 1, mf + 1) = 1.0;
+  for (u32 I = 1; I <= mc; ++I) {
+    T.at(I, 2 * I - 1) = 0.5;
+    T.at(I, 2 * I) = 0.5;
+  }
+
+  return T.assemble();
+}
+
+// Linear interpolation between coarse centers and boundary nodes
+static sp_mat prolongation(u32 mc) {
+  const u32 mf = 2 * mc;
+  Triplets T(mf + 2, mc + 2, 2 * mf + 2);
+
+  T.at(0, 0) = 1.0;
+  T.at(mf + 1, mc + 1) = 1.0;
+  for (u32 I = 1; I <= mc; ++I) {
+    // The boundary node is half as far from the first and last centers
+    const Real w = (I == 1) ? 0.5 : 0.25;
+    T.at(2 * I - 1, I) = 1.0 - w;
+    T.at(2 * I - 1, I - 1) = w;
+
+    const Real e = (I == mc) ? 0.5 : 0.25;
+    T.at(2 * I, I) = 1.0 - e;
+    T.at(2 * I, I + 1) = e;
+  }
+
+  return T.assemble();
+}
+
+// Tensor product of the 1-D transfers of every active direction
+static sp_mat transfer(sp_mat (*op)(u32), u32 m, u32 n, u32 o) {
+  sp_mat Tm = op(m);
+  if (!n)
+    return Tm;
+
+  sp_mat Tn = op(n);
+  if (!o)
+    return Utils::spkron_sum({KronTerm(Tn, Tm)}, Tn.n_rows * Tm.n_rows,
+                             Tn.n_cols * Tm.n_cols);
+
+  sp_mat To = op(o);
+  return Utils::spkron_sum({KronTerm(To, Tn, Tm)},
+                           To.n_rows * Tn.n_rows * Tm.n_rows,
+                           To.n_cols * Tn.n_cols * Tm.n_cols);
+}
+
+Multigrid::Multigrid(u16 k, u32 m, Real dx, Real a, Real b,
+                     const MultigridOptions &opts)
+    : opts(opts) {
+  setup(k, m, 0, 0, dx, 0, 0,
+        [k, a, b](u32 m, u32, u32, Real dx, Real, Real) -> sp_mat {
+          sp_mat A = Laplacian(k, m, dx);
+          BoundaryPatch::robin(k, m, dx, a, b).add_to(A);
+          return A;
+        });
+}
+
+Multigrid::Multigrid(u16 k, u32 m, u32 n, Real dx, Real dy, Real a, Real b,
+                     const MultigridOptions &opts)
+    : opts(opts) {
+  setup(k, m, n, 0, dx, dy, 0,
+        [k, a, b](u32 m, u32 n, u32, Real dx, Real dy, Real) -> sp_mat {
+          sp_mat A = Laplacian(k, m, n, dx, dy);
+          BoundaryPatch::robin(k, m, dx, n, dy, a, b).add_to(A);
+          return A;
+        });
+}
+
+Multigrid::Multigrid(u16 k, u32 m, u32 n, u32 o, Real dx, Real dy, Real dz,
+                     Real a, Real b, const MultigridOptions &opts)
+    : opts(opts) {
+  setup(k, m, n, o, dx, dy, dz,
+        [k, a, b](u32 m, u32 n, u32 o, Real dx, Real dy, Real dz) -> sp_mat {
+          sp_mat A = Laplacian(k, m, n, o, dx, dy, dz);
+          BoundaryPatch::robin(k, m, dx, n, dy, o, dz, a, b).add_to(A);
+          return A;
+        });
+}
+
+Multigrid::Multigrid(u16 k, u32 m, u32 n, u32 o, Real dx, Real dy, Real dz,
+                     const LevelBuilder &build, const MultigridOptions &opts)
+    : opts(opts) {
+  setup(k, m, n, o, dx, dy, dz, build);
+}
+
+void Multigrid::setup(u16 k, u32 m, u32 n, u32 o, Real dx, Real dy, Real dz,
+                      const LevelBuilder &build) {
+  assert(opts.cycle > 0 && opts.max_levels > 0);
+  assert(!o || n);
+
+  const u32 coarsest = opts.coarsest ? opts.coarsest : 2 * k + 1;
+
+  auto halves = [coarsest](u32 c) { return !c || (!(c % 2) && c / 2 >= coarsest); };
+
+  for (;;) {
+    sp_mat A = build(m, n, o, dx, dy, dz);
+
+    if (grid.size() + 1 == opts.max_levels || !halves(m) || !halves(n) ||
+        !halves(o)) {
+      coarse.factorize(A);
+      return;
+    }
+
+    grid.push_back(Level());
+    Level &L = grid.back();
+
+    // The columns of A^T are the rows of A
+    sp_mat At = A.t();
+    At.sync();
+    L.row_ptr.assign(At.col_ptrs, At.col_ptrs + At.n_cols + 1);
+    L.col_ind.assign(At.row_indices, At.row_indices + At.n_nonzero);
+    L.val.assign(At.values, At.values + At.n_nonzero);
+    L.diag.assign(A.n_rows, 0);
+
+    for (uword i = 0; i < A.n_rows; ++i) {
+      uword p = L.row_ptr[i];
+      while (p < L.row_ptr[i + 1] && L.col_ind[p] < i)
+        ++p;
+      if (p == L.row_ptr[i + 1] || L.col_ind[p] != i)
+        throw std::invalid_argument("Multigrid needs a nonzero diagonal");
+      L.diag[i] = p;
+    }
+
+    m /= 2;
+    n /= 2;
+    o /= 2;
+    dx *= 2;
+    dy *= 2;
+    dz *= 2;
+
+    L.R = transfer(restriction, m, n, o);
+    L.P = transfer(prolongation, m, n, o);
+  }
+}
+
+void Multigrid::smooth(const Level &L, const vec &b, vec &x, uword sweeps,
+                       bool forward) const {
+  const uword N = L.diag.size();
+
+  for (uword s = 0; s < sweeps; ++s) {
+    for (uword t = 0; t < N; ++t) {
+      const uword i = forward ? t : N - 1 - t;
+      Real sum = b(i);
+      for (uword p = L.row_ptr[i]; p < L.row_ptr[i + 1]; ++p)
+        if (p != L.diag[i])
+          sum -= L.val[p] * x(L.col_ind[p]);
+      x(i) = sum / L.val[L.diag[i]];
+    }
+  }
+}
+
+void Multigrid::residual(const Level &L, const vec &b, const vec &x,
+                         vec &r) const {
+  const uword N = L.diag.size();
+  r.set_size(N);
+
+#pragma omp parallel for schedule(static)
+  for (sword i = 0; i < static_cast<sword>(N); ++i) {
+    Real sum = b(i);
+    for (uword p = L.row_ptr[i]; p < L.row_ptr[i + 1]; ++p)
+      sum -= L.val[p] * x(L.col_ind[p]);
+    r(i) = sum;
+  }
+}
+
+void Multigrid::cycle(uword l, const vec &b, vec &x) const {
+  if (l == grid.size()) {
+    x = coarse.solve(b);
+    return;
+  }
+
+  const Level &L = grid[l];
+  vec r, ec;
+
+  smooth(L, b, x, opts.pre_smooth, true);
+
+  residual(L, b, x, r);
+  const vec rc = L.R * r;
+  ec.zeros(rc.n_elem);
+  for (uword g = 0; g < (l + 1 == grid.size() ? 1 : opts.cycle); ++g)
+    cycle(l + 1, rc, ec);
+  x += L.P * ec;
+
+  smooth(L, b, x, opts.post_smooth, false);
+}
+
+void Multigrid::apply(const vec &r, vec &z) const {
+  z.zeros(r.n_elem);
+  cycle(0, r, z);
+}
+
+KrylovResult Multigrid::solve(const vec &b, vec &x) const {
+  KrylovResult result;
+  vec r;
+
+  if (x.n_elem != b.n_elem)
+    x.zeros(b.n_elem);
+
+  if (grid.empty()) {
+    x = coarse.solve(b);
+    result.converged = true;
+    result.iterations = 1;
+    result.history.push_back(0.0);
+    return result;
+  }
+
+  const Real tol = opts.rtol * norm(b);
+  residual(grid[0], b, x, r);
+  result.residual = norm(r);
+
+  while (result.residual > tol && result.iterations < opts.max_cycles) {
+    cycle(0, b, x);
+    residual(grid[0], b, x, r);
+    result.residual = norm(r);
+    result.history.push_back(result.residual);
+    ++result.iterations;
+  }
+
+  result.converged = result.residual <= tol;
+  return result;
+}
+
+uword Multigrid::levels() const { return grid.size() + 1; }
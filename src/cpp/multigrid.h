@@ -0,0 +1,144 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file multigrid.h
+ *
+ * @brief Geometric multigrid for mimetic Laplacians on staggered grids
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef MULTIGRID_H
+#define MULTIGRID_H
+
+#include "krylov.h"
+#include "sparsesolver.h"
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Assembles the system matrix of one grid level
+ *
+ * Called with the number of cells and the spacing of every direction; the
+ * unused directions of 1-D and 2-D problems get n = o = 0. For example
+ * Laplacian(k, m, n, dx, dy) + MixedBC(k, m, dx, n, dy, ...) in 2-D.
+ */
+typedef std::function<sp_mat(u32 m, u32 n, u32 o, Real dx, Real dy, Real dz)>
+    LevelBuilder;
+
+/**
+ * @brief Cycle shape and stopping criteria of the multigrid solver
+ */
+struct MultigridOptions {
+  uword cycle = 1;           ///< Coarse corrections per level, 1 = V, 2 = W
+  uword pre_smooth = 2;      ///< Gauss-Seidel sweeps before restriction
+  uword post_smooth = 2;     ///< Gauss-Seidel sweeps after prolongation
+  u32 coarsest = 0;          ///< Fewest cells per direction, 0 picks 2k+1
+  uword max_levels = 20;     ///< Upper bound on the number of levels
+  Real rtol = 1e-8;          ///< Relative tolerance of solve()
+  uword max_cycles = 100;    ///< Cycle limit of solve()
+};
+
+/**
+ * @brief Geometric multigrid on the mimetic staggered grid
+ *
+ * Every level rediscretizes the problem with the existing constructors at
+ * half the number of cells, as long as all directions have an even number
+ * of cells above the coarsest size. Residuals are restricted by averaging
+ * the two fine cells of each coarse cell and corrections are prolongated by
+ * linear interpolation between cell centers and boundary nodes; boundary
+ * nodes are transferred by injection. The coarsest level is solved with a
+ * sparse LU factorization.
+ *
+ * Can be used on its own through solve() or, one cycle per application, as
+ * a preconditioner for the Krylov solvers.
+ */
+class Multigrid : public Preconditioner {
+
+public:
+  /**
+   * @brief 1-D Laplacian + RobinBC hierarchy
+   *
+   * @param k Order of accuracy
+   * @param m Number of cells
+   * @param dx Spacing between cells
+   * @param a Dirichlet coefficient of RobinBC
+   * @param b Neumann coefficient of RobinBC
+   * @param opts Cycle options
+   */
+  Multigrid(u16 k, u32 m, Real dx, Real a, Real b,
+            const MultigridOptions &opts = MultigridOptions());
+
+  /**
+   * @brief 2-D Laplacian + RobinBC hierarchy
+   */
+  Multigrid(u16 k, u32 m, u32 n, Real dx, Real dy, Real a, Real b,
+            const MultigridOptions &opts = MultigridOptions());
+
+  /**
+   * @brief 3-D Laplacian + RobinBC hierarchy
+   */
+  Multigrid(u16 k, u32 m, u32 n, u32 o, Real dx, Real dy, Real dz, Real a,
+            Real b, const MultigridOptions &opts = MultigridOptions());
+
+  /**
+   * @brief Hierarchy of user-assembled levels, e.g. with MixedBC
+   *
+   * @param k Order of accuracy, bounds the coarsest grid
+   * @param m Number of cells in x-direction
+   * @param n Number of cells in y-direction, 0 for 1-D
+   * @param o Number of cells in z-direction, 0 for 1-D and 2-D
+   * @param dx Spacing between cells in x-direction
+   * @param dy Spacing between cells in y-direction
+   * @param dz Spacing between cells in z-direction
+   * @param build Assembles the matrix of every level
+   * @param opts Cycle options
+   */
+  Multigrid(u16 k, u32 m, u32 n, u32 o, Real dx, Real dy, Real dz,
+            const LevelBuilder &build,
+            const MultigridOptions &opts = MultigridOptions());
+
+  /**
+   * @brief Cycles until ||b - A * x|| <= rtol * ||b||
+   *
+   * @param b Right-hand side
+   * @param x Initial guess when it has the size of b, solution on exit
+   */
+  KrylovResult solve(const vec &b, vec &x) const;
+
+  /**
+   * @brief One cycle from a zero initial guess, z ~ A^-1 * r
+   */
+  void apply(const vec &r, vec &z) const override;
+
+  /**
+   * @brief Number of grid levels, including the finest and the coarsest
+   */
+  uword levels() const;
+
+private:
+  struct Level {
+    // Matrix of the level, stored by rows for Gauss-Seidel
+    std::vector<uword> row_ptr, col_ind, diag;
+    std::vector<Real> val;
+    sp_mat R; // To the next coarser level
+    sp_mat P; // From the next coarser level
+  };
+
+  void setup(u16 k, u32 m, u32 n, u32 o, Real dx, Real dy, Real dz,
+             const LevelBuilder &build);
+  void smooth(const Level &L, const vec &b, vec &x, uword sweeps,
+              bool forward) const;
+  void residual(const Level &L, const vec &b, const vec &x, vec &r) const;
+  void cycle(uword l, const vec &b, vec &x) const;
+
+  MultigridOptions opts;
+  std::vector<Level> grid;
+  SparseSolver coarse;
+};
+
+#endif // MULTIGRID_H
@@ -0,0 +1,36 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file operatorcache.cpp
+ *
+ * @brief Shared registry of assembled mimetic operators
+ *
+ * @date 2024/10/15
+ */
+
+#include "operatorcache.h"
+
+OperatorCache &OperatorCache::global() {
+  static OperatorCache cache;
+  return cache;
+}
+
+uword OperatorCache::hits() const { return n_hits; }
+
+uword OperatorCache::misses() const { return n_misses; }
+
+uword OperatorCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return entries.size();
+}
+
+void OperatorCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  entries.clear();
+  n_hits = 0;
+  n_misses = 0;
+}
@@ -0,0 +1,126 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file operatorcache.h
+ *
+ * @brief Shared registry of assembled mimetic operators
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef OPERATORCACHE_H
+#define OPERATORCACHE_H
+
+#include "utils.h"
+#include <atomic>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Thread-safe registry of immutable operators
+ *
+ * Operators are keyed by their type and constructor arguments, e.g.
+ * (Laplacian, k, m, n, o, dx, dy, dz). The first request for a key assembles
+ * the operator; concurrent requests for the same key wait for that assembly
+ * instead of repeating it, and later requests share the same object.
+ *
+ * @code
+ * auto L = OperatorCache::global().get<Laplacian>(k, m, n, o, dx, dy, dz);
+ * vec y = *L * x;
+ * @endcode
+ */
+class OperatorCache {
+
+public:
+  /**
+   * @brief Process-wide registry
+   */
+  static OperatorCache &global();
+
+  /**
+   * @brief Returns the operator built from the given constructor arguments
+   *
+   * @param args Constructor arguments of Op, e.g. (k, m, dx) for a 1-D
+   * Gradient
+   */
+  template <typename Op, typename... Args>
+  std::shared_ptr<const Op> get(Args... args);
+
+  /**
+   * @brief Number of requests served from the registry
+   */
+  uword hits() const;
+
+  /**
+   * @brief Number of requests that assembled a new operator
+   */
+  uword misses() const;
+
+  /**
+   * @brief Number of operators held by the registry
+   */
+  uword size() const;
+
+  /**
+   * @brief Drops every operator and resets the counters
+   *
+   * Operators still referenced elsewhere stay alive until released.
+   */
+  void clear();
+
+private:
+  typedef std::pair<std::type_index, std::vector<Real>> Key;
+  typedef std::shared_future<std::shared_ptr<const sp_mat>> Entry;
+
+  mutable std::mutex mutex;
+  std::map<Key, Entry> entries;
+  std::atomic<uword> n_hits{0};
+  std::atomic<uword> n_misses{0};
+};
+
+template <typename Op, typename... Args>
+std::shared_ptr<const Op> OperatorCache::get(Args... args) {
+  const Key key(std::type_index(typeid(Op)),
+                std::vector<Real>{static_cast<Real>(args)...});
+
+  std::promise<std::shared_ptr<const sp_mat>> promise;
+  Entry entry;
+  bool owner = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+      ++n_hits;
+      entry = it->second;
+    } else {
+      ++n_misses;
+      entry = promise.get_future().share();
+      entries.emplace(key, entry);
+      owner = true;
+    }
+  }
+
+  // Assemble outside the lock so other keys are not held up
+  if (owner) {
+    try {
+      promise.set_value(std::make_shared<const Op>(args...));
+    } catch (...) {
+      promise.set_exception(std::current_exception());
+      std::lock_guard<std::mutex> lock(mutex);
+      entries.erase(key);
+    }
+  }
+
+  return std::static_pointer_cast<const Op>(entry.get());
+}
+
+#endif // OPERATORCACHE_H
@@ -29,57 +29,60 @@
 #include "mixedbc.h"
 #include "robinbc.h"
 
+// The operators bind to their sp_mat base by reference; a (sp_mat) cast
+// would copy the whole matrix on every call.
+
 inline sp_mat operator*(const Divergence &div, const Gradient &grad) {
-  return (sp_mat)div * (sp_mat)grad;
+  return static_cast<const sp_mat &>(div) * static_cast<const sp_mat &>(grad);
 }
 
 inline sp_mat operator+(const Laplacian &lap, const RobinBC &bc) {
-  return (sp_mat)lap + (sp_mat)bc;
+  return static_cast<const sp_mat &>(lap) + static_cast<const sp_mat &>(bc);
 }
 
 inline sp_mat operator+(const Laplacian &lap, const MixedBC &bc) {
-  return (sp_mat)lap + (sp_mat)bc;
+  return static_cast<const sp_mat &>(lap) + static_cast<const sp_mat &>(bc);
 }
 
 inline vec operator*(const Divergence &div, const vec &v) {
-  return (sp_mat)div * v;
+  return static_cast<const sp_mat &>(div) * v;
 }
 
 inline vec operator*(const Gradient &grad, const vec &v) {
-  return (sp_mat)grad * v;
+  return static_cast<const sp_mat &>(grad) * v;
 }
 
 inline vec operator*(const Laplacian &lap, const vec &v) {
-  return (sp_mat)lap * v;
+  return static_cast<const sp_mat &>(lap) * v;
 }
 
 inline vec operator*(const Interpol &I, const vec &v) { 
-  return (sp_mat)I * v; 
+  return static_cast<const sp_mat &>(I) * v; 
 }
 
 // Add scalar multiplication operators
 inline sp_mat operator*(const double scalar, const Interpol& I) {
-    return scalar * (sp_mat)I;
+    return scalar * static_cast<const sp_mat &>(I);
 }
 
 inline sp_mat operator*(const Interpol& I, const double scalar) {
-    return scalar * (sp_mat)I;
+    return scalar * static_cast<const sp_mat &>(I);
 }
 
 inline sp_mat operator*(const double scalar, const Laplacian& L) {
-    return scalar * (sp_mat)L;
+    return scalar * static_cast<const sp_mat &>(L);
 }
 
 inline sp_mat operator*(const Laplacian& L, const double scalar) {
-    return scalar * (sp_mat)L;
+    return scalar * static_cast<const sp_mat &>(L);
 }
 
 inline sp_mat operator*(const double scalar, const RobinBC& bc) {
-    return scalar * (sp_mat)bc;
+    return scalar * static_cast<const sp_mat &>(bc);
 }
 
 inline sp_mat operator*(const RobinBC& bc, const double scalar) {
-    return scalar * (sp_mat)bc;
+    return scalar * static_cast<const sp_mat &>(bc);
 }
 
 #endif // OPERATORS_H
@@ -0,0 +1,198 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file operatorstore.cpp
+ *
+ * @brief Binary on-disk storage of assembled operators
+ *
+ * @date 2024/10/15
+ */
+
+#include "operatorstore.h"
+#include <cassert>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char store_magic[8] = {'M', 'O', 'L', 'E', 'O', 'P', 'S', '\0'};
+static const u32 store_byte_order = 0x01020304;
+
+static_assert(sizeof(uword) == sizeof(u64),
+              "the mapped CSC arrays require 64-bit Armadillo indices");
+static_assert(sizeof(OperatorHeader) % sizeof(u64) == 0,
+              "the CSC arrays must stay 8-byte aligned");
+
+void OperatorStore::save(const std::string &path, const sp_mat &A,
+                         const std::string &type,
+                         const std::vector<Real> &params) {
+  OperatorHeader h;
+  std::memset(&h, 0, sizeof(h));
+
+  if (type.size() >= sizeof(h.type))
+    throw std::invalid_argument("Operator name is too long");
+  if (params.size() > sizeof(h.params) / sizeof(Real))
+    throw std::invalid_argument("Too many operator parameters");
+
+  std::memcpy(h.magic, store_magic, sizeof(h.magic));
+  h.version = version;
+  h.byte_order = store_byte_order;
+  std::memcpy(h.type, type.data(), type.size());
+  h.n_params = params.size();
+  std::copy(params.begin(), params.end(), h.params);
+  // Pending element writes change n_nonzero
+  A.sync();
+  h.n_rows = A.n_rows;
+  h.n_cols = A.n_cols;
+  h.n_nonzero = A.n_nonzero;
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out)
+    throw std::runtime_error("Cannot open " + path + " for writing");
+
+  out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+  out.write(reinterpret_cast<const char *>(A.col_ptrs),
+            (A.n_cols + 1) * sizeof(uword));
+  out.write(reinterpret_cast<const char *>(A.row_indices),
+            A.n_nonzero * sizeof(uword));
+  out.write(reinterpret_cast<const char *>(A.values),
+            A.n_nonzero * sizeof(Real));
+
+  if (!out)
+    throw std::runtime_error("Cannot write " + path);
+}
+
+MappedOperator::MappedOperator(const std::string &path)
+    : n_rows(0), n_cols(0), n_nonzero(0), col_ptrs(nullptr),
+      row_indices(nullptr), values(nullptr), data(nullptr), length(0) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Cannot open " + path);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(OperatorHeader)) {
+    close(fd);
+    throw std::runtime_error(path + " is not an operator file");
+  }
+
+  length = st.st_size;
+  data = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (data == MAP_FAILED) {
+    data = nullptr;
+    throw std::runtime_error("Cannot map " + path);
+  }
+
+  const OperatorHeader &h = header();
+  const char *error = nullptr;
+
+  // Words after the header, compared term by term so that hostile sizes
+  // cannot overflow
+  const size_t payload = length - sizeof(OperatorHeader);
+  const u64 words = payload / sizeof(u64);
+
+  if (std::memcmp(h.magic, store_magic, sizeof(h.magic)) != 0)
+    error = " is not an operator file";
+  else if (h.byte_order != store_byte_order)
+    error = " was written with a different byte order";
+  else if (h.version != OperatorStore::version)
+    error = " has an unsupported format version";
+  else if (std::memchr(h.type, '\0', sizeof(h.type)) == nullptr ||
+           h.n_params > sizeof(h.params) / sizeof(Real))
+    error = " has a corrupt header";
+  else if (payload % sizeof(u64) != 0 || h.n_cols >= words ||
+           h.n_nonzero > (words - h.n_cols - 1) / 2 ||
+           words != h.n_cols + 1 + 2 * h.n_nonzero)
+    error = " is truncated";
+
+  if (error) {
+    munmap(data, length);
+    data = nullptr;
+    throw std::runtime_error(path + error);
+  }
+
+  n_rows = h.n_rows;
+  n_cols = h.n_cols;
+  n_nonzero = h.n_nonzero;
+
+  const char *base = static_cast<const char *>(data) + sizeof(OperatorHeader);
+  col_ptrs = reinterpret_cast<const uword *>(base);
+  row_indices = col_ptrs + n_cols + 1;
+  values = reinterpret_cast<const Real *>(row_indices + n_nonzero);
+
+  // apply() indexes with these arrays, so they must describe a valid CSC
+  // matrix: column pointers from 0 to n_nonzero without decreasing, and
+  // increasing row indices below n_rows in each column
+  bool valid = col_ptrs[0] == 0 && col_ptrs[n_cols] == n_nonzero;
+  for (uword j = 0; valid && j < n_cols; ++j) {
+    const uword begin = col_ptrs[j], end = col_ptrs[j + 1];
+    valid = begin <= end && end <= n_nonzero;
+    for (uword p = begin; valid && p < end; ++p)
+      valid = row_indices[p] < n_rows &&
+              (p == begin || row_indices[p - 1] < row_indices[p]);
+  }
+
+  if (!valid) {
+    munmap(data, length);
+    data = nullptr;
+    throw std::runtime_error(path + " has corrupt CSC arrays");
+  }
+}
+
+MappedOperator::MappedOperator(MappedOperator &&other)
+    : n_rows(other.n_rows), n_cols(other.n_cols),
+      n_nonzero(other.n_nonzero), col_ptrs(other.col_ptrs),
+      row_indices(other.row_indices), values(other.values), data(other.data),
+      length(other.length) {
+  other.data = nullptr;
+  other.length = 0;
+}
+
+MappedOperator::~MappedOperator() {
+  if (data)
+    munmap(data, length);
+}
+
+const OperatorHeader &MappedOperator::header() const {
+  return *static_cast<const OperatorHeader *>(data);
+}
+
+bool MappedOperator::matches(const std::string &type,
+                             const std::vector<Real> &params) const {
+  const OperatorHeader &h = header();
+
+  if (type != std::string(h.type) || params.size() != h.n_params)
+    return false;
+
+  return std::equal(params.begin(), params.end(), h.params);
+}
+
+void MappedOperator::apply(const vec &x, vec &y) const {
+  assert(x.n_elem == n_cols);
+
+  y.zeros(n_rows);
+  Real *py = y.memptr();
+
+  for (uword j = 0; j < n_cols; ++j) {
+    const Real xj = x(j);
+    for (uword p = col_ptrs[j]; p < col_ptrs[j + 1]; ++p)
+      py[row_indices[p]] += values[p] * xj;
+  }
+}
+
+LinearOperator MappedOperator::linear_operator() const {
+  return [this](const vec &x, vec &y) { apply(x, y); };
+}
+
+sp_mat MappedOperator::to_sp_mat() const {
+  return sp_mat(uvec(row_indices, n_nonzero), uvec(col_ptrs, n_cols + 1),
+                vec(values, n_nonzero), n_rows, n_cols);
+}
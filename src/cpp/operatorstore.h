@@ -0,0 +1,132 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file operatorstore.h
+ *
+ * @brief Binary on-disk storage of assembled operators
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef OPERATORSTORE_H
+#define OPERATORSTORE_H
+
+#include "krylov.h"
+#include "utils.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief Versioned binary CSC file layout
+ *
+ * The header is followed by col_ptrs (n_cols + 1 entries), row_indices and
+ * values (n_nonzero entries each), all 8 bytes wide, so the arrays can be
+ * used in place once the file is mapped.
+ */
+struct OperatorHeader {
+  char magic[8];    ///< "MOLEOPS" followed by a zero byte
+  u32 version;      ///< Format version, see OperatorStore::version
+  u32 byte_order;   ///< 0x01020304 as written by the producing machine
+  char type[32];    ///< Operator name, e.g. "Laplacian"
+  u32 n_params;     ///< Number of constructor parameters used
+  u32 reserved;
+  Real params[12];  ///< Constructor parameters, e.g. k, m, n, o, dx, dy, dz
+  u64 n_rows;
+  u64 n_cols;
+  u64 n_nonzero;
+};
+
+/**
+ * @brief Read-only operator mapped from a file written by OperatorStore
+ *
+ * The CSC arrays point straight into the mapped file, so loading costs a
+ * page-in and one pass over the indices, which are validated, instead of an
+ * assembly. The Krylov solvers use the mapped arrays through
+ * linear_operator(); to_sp_mat() copies them where an Armadillo matrix is
+ * required, e.g. for a direct solve.
+ */
+class MappedOperator {
+
+public:
+  /**
+   * @brief Maps an operator file
+   *
+   * Throws std::runtime_error if the file is not a complete, well-formed
+   * operator file.
+   *
+   * @param path File written by OperatorStore::save
+   */
+  explicit MappedOperator(const std::string &path);
+
+  MappedOperator(MappedOperator &&other);
+  MappedOperator(const MappedOperator &) = delete;
+  MappedOperator &operator=(const MappedOperator &) = delete;
+  ~MappedOperator();
+
+  /**
+   * @brief Checks the operator name and constructor parameters in the header
+   *
+   * @param type Operator name given to OperatorStore::save
+   * @param params Constructor parameters given to OperatorStore::save
+   */
+  bool matches(const std::string &type, const std::vector<Real> &params) const;
+
+  /**
+   * @brief y = A * x using the mapped arrays
+   *
+   * @param x Input vector with n_cols entries
+   * @param y Output vector, resized to n_rows entries
+   */
+  void apply(const vec &x, vec &y) const;
+
+  /**
+   * @brief Action of the mapped operator for the Krylov solvers
+   *
+   * Refers to this object, which must outlive the returned function.
+   */
+  LinearOperator linear_operator() const;
+
+  /**
+   * @brief Copies the mapped arrays into an Armadillo sparse matrix
+   */
+  sp_mat to_sp_mat() const;
+
+  const OperatorHeader &header() const;
+
+  uword n_rows;
+  uword n_cols;
+  uword n_nonzero;
+  const uword *col_ptrs;
+  const uword *row_indices;
+  const Real *values;
+
+private:
+  void *data;
+  size_t length;
+};
+
+/**
+ * @brief Writes operators in the format read by MappedOperator
+ */
+class OperatorStore {
+
+public:
+  static const u32 version = 1;
+
+  /**
+   * @brief Saves an assembled operator together with how it was built
+   *
+   * @param path Destination file, overwritten if it exists
+   * @param A Assembled operator, e.g. a Laplacian or Laplacian + RobinBC
+   * @param type Operator name recorded in the header
+   * @param params Constructor parameters recorded in the header (at most 12)
+   */
+  static void save(const std::string &path, const sp_mat &A,
+                   const std::string &type, const std::vector<Real> &params);
+};
+
+#endif // OPERATORSTORE_H
@@ -0,0 +1,142 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file parametricbc.cpp
+ *
+ * @brief Boundary operator with coefficients that can change in place
+ *
+ * @date 2024/10/15
+ */
+
+#include "parametricbc.h"
+#include "boundarypatch.h"
+#include "robinbc.h"
+#include <cassert>
+#include <stdexcept>
+
+namespace {
+
+// Value of A at (r, j), zero if not stored
+Real stored(const sp_mat &A, uword r, uword j) {
+  for (uword p = A.col_ptrs[j]; p < A.col_ptrs[j + 1]; ++p)
+    if (A.row_indices[p] == r)
+      return A.values[p];
+  return 0.0;
+}
+
+sp_mat patch(const std::vector<sp_mat> &B) {
+  if (B.size() == 1)
+    return BoundaryPatch(B[0]).assemble();
+  if (B.size() == 2)
+    return BoundaryPatch(B[0], B[1]).assemble();
+  return BoundaryPatch(B[0], B[1], B[2]).assemble();
+}
+
+} // namespace
+
+ParametricBC::ParametricBC(u16 k, u32 m, Real dx, Real a, Real b) {
+  setup({RobinBC(k, m, dx, 1, 0)}, {RobinBC(k, m, dx, 0, 1)});
+  set_coefficients(a, b);
+}
+
+ParametricBC::ParametricBC(u16 k, u32 m, Real dx, u32 n, Real dy, Real a,
+                           Real b) {
+  setup({RobinBC(k, m, dx, 1, 0), RobinBC(k, n, dy, 1, 0)},
+        {RobinBC(k, m, dx, 0, 1), RobinBC(k, n, dy, 0, 1)});
+  set_coefficients(a, b);
+}
+
+ParametricBC::ParametricBC(u16 k, u32 m, Real dx, u32 n, Real dy, u32 o,
+                           Real dz, Real a, Real b) {
+  setup({RobinBC(k, m, dx, 1, 0), RobinBC(k, n, dy, 1, 0),
+         RobinBC(k, o, dz, 1, 0)},
+        {RobinBC(k, m, dx, 0, 1), RobinBC(k, n, dy, 0, 1),
+         RobinBC(k, o, dz, 0, 1)});
+  set_coefficients(a, b);
+}
+
+void ParametricBC::setup(const std::vector<sp_mat> &D,
+                         const std::vector<sp_mat> &G) {
+  const u32 dims = D.size();
+  this->a.assign(2 * dims, 0.0);
+  this->b.assign(2 * dims, 0.0);
+
+  uword size[3] = {1, 1, 1};
+  for (u32 d = 0; d < dims; ++d)
+    size[d] = D[d].n_rows;
+
+  const sp_mat Dp = patch(D);
+  const sp_mat Gp = patch(G);
+  sp_mat::operator=(Utils::spmerge(Dp, Gp));
+  sync();
+
+  for (uword j = 0; j < n_cols; ++j) {
+    for (uword p = col_ptrs[j]; p < col_ptrs[j + 1]; ++p) {
+      const uword r = row_indices[p];
+      const uword i[3] = {r % size[0], (r / size[0]) % size[1],
+                          r / (size[0] * size[1])};
+
+      // The row belongs to the last axis on whose boundary it lies
+      u32 face = 0;
+      for (u32 d = 0; d < dims; ++d) {
+        if (i[d] == 0)
+          face = 2 * d;
+        else if (i[d] == size[d] - 1)
+          face = 2 * d + 1;
+      }
+
+      slots.push_back({p, face, 0.0, stored(Dp, r, j), stored(Gp, r, j)});
+    }
+  }
+}
+
+void ParametricBC::add(const sp_mat &A) {
+  if (A.n_rows != n_rows || A.n_cols != n_cols)
+    throw std::invalid_argument(
+        "ParametricBC does not match the size of the operator");
+
+  // With the boundary part zeroed the merge leaves A's values in the slots
+  for (const Slot &s : slots)
+    access::rw(values[s.pos]) = 0.0;
+
+  std::vector<uword> pos;
+  sp_mat S = Utils::spmerge(A, *this, &pos);
+
+  for (Slot &s : slots) {
+    s.pos = pos[s.pos];
+    s.base += S.values[s.pos];
+  }
+
+  sp_mat::operator=(std::move(S));
+  sync();
+
+  for (u32 f = 0; f < faces(); ++f)
+    update(f);
+}
+
+void ParametricBC::set_coefficients(Real a, Real b) {
+  for (u32 f = 0; f < faces(); ++f)
+    set_coefficients(f, a, b);
+}
+
+void ParametricBC::set_coefficients(u32 face, Real a, Real b) {
+  if (face >= faces())
+    throw std::out_of_range("ParametricBC: face out of range");
+
+  this->a[face] = a;
+  this->b[face] = b;
+  update(face);
+}
+
+u32 ParametricBC::faces() const { return a.size(); }
+
+void ParametricBC::update(u32 face) {
+  const Real af = a[face], bf = b[face];
+  for (const Slot &s : slots)
+    if (s.face == face)
+      access::rw(values[s.pos]) = s.base + af * s.dirichlet + bf * s.gradient;
+}
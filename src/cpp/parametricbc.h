@@ -0,0 +1,115 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file parametricbc.h
+ *
+ * @brief Boundary operator with coefficients that can change in place
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef PARAMETRICBC_H
+#define PARAMETRICBC_H
+
+#include "utils.h"
+#include <vector>
+
+/**
+ * @brief Robin / mixed boundary operator whose coefficients are updated in
+ * place
+ *
+ * Keeps the Dirichlet part and the gradient rows of RobinBC apart, so
+ * set_coefficients() rewrites only the values of the boundary rows. The
+ * sparsity pattern holds both parts whatever the coefficients, zeros
+ * included, and never changes, which lets a SparseSolver refactorize the
+ * new values without a new symbolic analysis.
+ *
+ * Each face has its own pair (a, b), which also covers MixedBC: Dirichlet
+ * faces are (c, 0), Neumann faces (0, c) and Robin faces (c0, c1). Faces
+ * are numbered left, right, bottom, top, front, back.
+ *
+ * @code
+ * ParametricBC A(k, m, dx, n, dy, 1, 1);
+ * A.add(Laplacian(k, m, n, dx, dy));
+ * SparseSolver solver(A);
+ * for (Real a : trials) {
+ *   A.set_coefficients(a, 1);
+ *   solver.refactorize(A);
+ *   u = solver.solve(rhs);
+ * }
+ * @endcode
+ */
+class ParametricBC : public sp_mat {
+
+public:
+  /**
+   * @brief 1-D operator, equal to RobinBC(k, m, dx, a, b)
+   *
+   * @param k Order of accuracy
+   * @param m Number of cells
+   * @param dx Spacing between cells
+   * @param a Coefficient of the Dirichlet function on every face
+   * @param b Coefficient of the Neumann function on every face
+   */
+  ParametricBC(u16 k, u32 m, Real dx, Real a, Real b);
+
+  /**
+   * @brief 2-D operator, equal to RobinBC(k, m, dx, n, dy, a, b)
+   */
+  ParametricBC(u16 k, u32 m, Real dx, u32 n, Real dy, Real a, Real b);
+
+  /**
+   * @brief 3-D operator, equal to RobinBC(k, m, dx, n, dy, o, dz, a, b)
+   */
+  ParametricBC(u16 k, u32 m, Real dx, u32 n, Real dy, u32 o, Real dz, Real a,
+               Real b);
+
+  /**
+   * @brief *this = A + *this, keeping the boundary coefficients adjustable
+   *
+   * Typically called once with the Laplacian, after which the object is the
+   * full system matrix.
+   *
+   * @param A Operator of the same size
+   */
+  void add(const sp_mat &A);
+
+  /**
+   * @brief Same coefficients on every face
+   */
+  void set_coefficients(Real a, Real b);
+
+  /**
+   * @brief Coefficients of one face
+   *
+   * @param face 0 left, 1 right, 2 bottom, 3 top, 4 front, 5 back
+   * @param a Coefficient of the Dirichlet function
+   * @param b Coefficient of the Neumann function
+   */
+  void set_coefficients(u32 face, Real a, Real b);
+
+  /**
+   * @brief Number of faces, two per dimension
+   */
+  u32 faces() const;
+
+private:
+  // A stored value of a boundary row, base + a * dirichlet + b * gradient
+  struct Slot {
+    uword pos;
+    u32 face;
+    Real base, dirichlet, gradient;
+  };
+
+  void setup(const std::vector<sp_mat> &D, const std::vector<sp_mat> &G);
+  void update(u32 face);
+
+  std::vector<Slot> slots;
+  std::vector<Real> a, b; // Coefficients per face
+};
+
+#endif // PARAMETRICBC_H
@@ -0,0 +1,51 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file schrodinger.cpp
+ *
+ * @brief Implicit integrators for the time-dependent Schrodinger equation
+ *
+ * @date 2024/10/15
+ */
+
+#include "schrodinger.h"
+#include <cassert>
+
+CrankNicolson::CrankNicolson(const cx_sp_mat &H, Real dt) {
+  assert(H.n_rows == H.n_cols);
+
+  const cx_sp_mat I = speye<cx_sp_mat>(H.n_rows, H.n_cols);
+  const cx_double half(0.0, 0.5 * dt);
+
+  B = I - half * H;
+  solver.factorize(cx_sp_mat(I + half * H));
+  rhs.set_size(H.n_rows);
+}
+
+void CrankNicolson::step(cx_vec &psi, uword steps) {
+  assert(psi.n_elem == B.n_cols);
+
+  for (uword s = 0; s < steps; ++s) {
+    rhs = B * psi;
+    psi = solver.solve(rhs);
+  }
+}
+
+SplitStep::SplitStep(const cx_sp_mat &T, const vec &V, Real dt)
+    : kinetic(T, dt) {
+  assert(V.n_elem == T.n_rows);
+
+  half_phase = exp(cx_double(0.0, -0.5 * dt) * conv_to<cx_vec>::from(V));
+}
+
+void SplitStep::step(cx_vec &psi, uword steps) {
+  for (uword s = 0; s < steps; ++s) {
+    psi %= half_phase;
+    kinetic.step(psi);
+    psi %= half_phase;
+  }
+}
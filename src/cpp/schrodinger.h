@@ -0,0 +1,87 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file schrodinger.h
+ *
+ * @brief Implicit integrators for the time-dependent Schrodinger equation
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef SCHRODINGER_H
+#define SCHRODINGER_H
+
+#include "sparsesolver.h"
+#include "utils.h"
+
+/**
+ * @brief Crank-Nicolson integrator of i * dpsi/dt = H * psi
+ *
+ * Every step solves (I + i dt/2 H) psi' = (I - i dt/2 H) psi with a
+ * complex factorization computed once. The scheme is unconditionally stable
+ * and second order, and it preserves the norm of psi when H is Hermitian.
+ *
+ * @code
+ * cx_sp_mat H = -0.5 * cxLaplacian(k, m, n, dx, dy);
+ * CrankNicolson cn(H, dt);
+ * cn.step(psi, steps);
+ * @endcode
+ */
+class CrankNicolson {
+
+public:
+  /**
+   * @param H Hamiltonian
+   * @param dt Time step
+   */
+  CrankNicolson(const cx_sp_mat &H, Real dt);
+
+  /**
+   * @brief Advances psi by one or more time steps, in place
+   *
+   * @param psi Wavefunction
+   * @param steps Number of steps
+   */
+  void step(cx_vec &psi, uword steps = 1);
+
+private:
+  cx_sp_mat B; // I - i dt/2 H
+  cxSparseSolver solver;
+  cx_vec rhs;
+};
+
+/**
+ * @brief Strang split-step integrator of i * dpsi/dt = (T + V) * psi
+ *
+ * The potential V is diagonal, so its half steps are pointwise phase
+ * factors exp(-i V dt/2), computed once. The kinetic part T is advanced
+ * with CrankNicolson.
+ */
+class SplitStep {
+
+public:
+  /**
+   * @param T Kinetic part of the Hamiltonian, e.g. -0.5 * cxLaplacian
+   * @param V Potential at every unknown of psi
+   * @param dt Time step
+   */
+  SplitStep(const cx_sp_mat &T, const vec &V, Real dt);
+
+  /**
+   * @brief Advances psi by one or more time steps, in place
+   *
+   * @param psi Wavefunction
+   * @param steps Number of steps
+   */
+  void step(cx_vec &psi, uword steps = 1);
+
+private:
+  CrankNicolson kinetic;
+  cx_vec half_phase;
+};
+
+#endif // SCHRODINGER_H
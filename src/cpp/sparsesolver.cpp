@@ -0,0 +1,165 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file sparsesolver.cpp
+ *
+ * @brief Reusable sparse LU factorization
+ *
+ * @date 2024/10/15
+ */
+
+#include "sparsesolver.h"
+#include <cassert>
+#include <stdexcept>
+
+#ifdef EIGEN
+#include "eigenbridge.h"
+#include <algorithm>
+#include <eigen3/Eigen/SparseLU>
+
+template <typename eT> struct SparseSolverT<eT>::Impl {
+  typedef Eigen::SparseMatrix<eT, Eigen::ColMajor, EigenBridge::Index> Matrix;
+
+  // SparseLU only takes a SparseMatrix, so the operator is copied once and
+  // refactorize() overwrites the values of that copy in place
+  Matrix A;
+  Eigen::SparseLU<Matrix, Eigen::COLAMDOrdering<EigenBridge::Index>> lu;
+  uword n_rows;
+  uword n_nonzero;
+};
+
+template <typename eT>
+void SparseSolverT<eT>::factorize(const SpMat<eT> &A) {
+  assert(A.n_rows == A.n_cols);
+
+  A.sync();
+  impl.reset(new Impl);
+  impl->n_rows = A.n_rows;
+  impl->n_nonzero = A.n_nonzero;
+
+  impl->A = EigenBridge::map(A);
+  impl->lu.analyzePattern(impl->A);
+  impl->lu.factorize(impl->A);
+
+  if (impl->lu.info() != Eigen::Success) {
+    impl.reset();
+    throw std::runtime_error("SparseSolver: factorization failed");
+  }
+}
+
+template <typename eT>
+void SparseSolverT<eT>::refactorize(const SpMat<eT> &A) {
+  assert(factorized());
+
+  A.sync();
+  if (A.n_rows != impl->n_rows || A.n_cols != impl->n_rows ||
+      A.n_nonzero != impl->n_nonzero ||
+      !std::equal(A.col_ptrs, A.col_ptrs + A.n_cols + 1,
+                  impl->A.outerIndexPtr()) ||
+      !std::equal(A.row_indices, A.row_indices + A.n_nonzero,
+                  impl->A.innerIndexPtr()))
+    throw std::invalid_argument(
+        "SparseSolver: refactorize needs the pattern of the factorized matrix");
+
+  std::copy(A.values, A.values + A.n_nonzero, impl->A.valuePtr());
+  impl->lu.factorize(impl->A);
+
+  if (impl->lu.info() != Eigen::Success) {
+    impl.reset();
+    throw std::runtime_error("SparseSolver: factorization failed");
+  }
+}
+
+template <typename eT>
+Col<eT> SparseSolverT<eT>::solve(const Col<eT> &b) const {
+  assert(factorized());
+  assert(b.n_elem == impl->n_rows);
+
+  Col<eT> x(b.n_elem);
+  EigenBridge::map(x) = impl->lu.solve(EigenBridge::map(b));
+
+  return x;
+}
+
+#else
+
+template <typename eT> struct SparseSolverT<eT>::Impl {
+  spsolve_factoriser lu;
+  uword n_rows;
+  uword n_nonzero;
+};
+
+template <typename eT>
+void SparseSolverT<eT>::factorize(const SpMat<eT> &A) {
+  assert(A.n_rows == A.n_cols);
+
+  A.sync();
+  impl.reset(new Impl);
+  impl->n_rows = A.n_rows;
+  impl->n_nonzero = A.n_nonzero;
+
+  if (!impl->lu.factorise(A)) {
+    impl.reset();
+    throw std::runtime_error("SparseSolver: factorization failed");
+  }
+}
+
+// SuperLU through Armadillo offers no numeric-only refactorization, so the
+// pattern is only checked and the matrix is factorized again
+template <typename eT>
+void SparseSolverT<eT>::refactorize(const SpMat<eT> &A) {
+  assert(factorized());
+
+  A.sync();
+  if (A.n_rows != impl->n_rows || A.n_cols != impl->n_rows ||
+      A.n_nonzero != impl->n_nonzero)
+    throw std::invalid_argument(
+        "SparseSolver: refactorize needs the pattern of the factorized matrix");
+
+  if (!impl->lu.factorise(A)) {
+    impl.reset();
+    throw std::runtime_error("SparseSolver: factorization failed");
+  }
+}
+
+template <typename eT>
+Col<eT> SparseSolverT<eT>::solve(const Col<eT> &b) const {
+  assert(factorized());
+  assert(b.n_elem == impl->n_rows);
+
+  Col<eT> x;
+  if (!impl->lu.solve(x, b))
+    throw std::runtime_error("SparseSolver: solve failed");
+
+  return x;
+}
+
+#endif
+
+template <typename eT> SparseSolverT<eT>::SparseSolverT() {}
+
+template <typename eT> SparseSolverT<eT>::SparseSolverT(const SpMat<eT> &A) {
+  factorize(A);
+}
+
+template <typename eT> SparseSolverT<eT>::~SparseSolverT() {}
+
+template <typename eT> bool SparseSolverT<eT>::factorized() const {
+  return impl != nullptr;
+}
+
+template <typename eT>
+Mat<eT> SparseSolverT<eT>::solve(const Mat<eT> &B) const {
+  Mat<eT> X(B.n_rows, B.n_cols);
+  for (uword j = 0; j < B.n_cols; ++j)
+    X.col(j) = solve(Col<eT>(B.col(j)));
+
+  return X;
+}
+
+template class SparseSolverT<Real>;
+template class SparseSolverT<cx_double>;
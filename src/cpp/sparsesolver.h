@@ -0,0 +1,94 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file sparsesolver.h
+ *
+ * @brief Reusable sparse LU factorization
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef SPARSESOLVER_H
+#define SPARSESOLVER_H
+
+#include "utils.h"
+#include <memory>
+
+/**
+ * @brief Direct solver that keeps the LU factorization of an operator
+ *
+ * Factorizes once and then solves any number of right-hand sides, which is
+ * what time-stepping loops with a fixed operator need. Uses Eigen's SparseLU
+ * when EIGEN is defined and Armadillo's SuperLU interface otherwise.
+ * SparseSolver works on real operators, cxSparseSolver on complex ones.
+ *
+ * @code
+ * SparseSolver solver(L);
+ * for (int t = 0; t < steps; ++t)
+ *   p = solver.solve(b);
+ * @endcode
+ */
+template <typename eT> class SparseSolverT {
+
+public:
+  SparseSolverT();
+
+  /**
+   * @brief Analyzes and factorizes A
+   *
+   * @param A Square sparse matrix
+   */
+  explicit SparseSolverT(const SpMat<eT> &A);
+
+  ~SparseSolverT();
+
+  /**
+   * @brief Analyzes and factorizes a new matrix
+   *
+   * @param A Square sparse matrix
+   */
+  void factorize(const SpMat<eT> &A);
+
+  /**
+   * @brief Factorizes new values of the matrix given to factorize()
+   *
+   * Reuses the symbolic analysis, so A must have the same sparsity pattern.
+   * Throws std::invalid_argument if it does not; the SuperLU build factorizes
+   * from scratch and checks only the size and number of nonzeros.
+   *
+   * @param A Square sparse matrix with the pattern of the factorized one
+   */
+  void refactorize(const SpMat<eT> &A);
+
+  /**
+   * @brief Solves A * x = b with the stored factorization
+   *
+   * @param b Right-hand side
+   */
+  Col<eT> solve(const Col<eT> &b) const;
+
+  /**
+   * @brief Solves A * X = B column by column with the stored factorization
+   *
+   * @param B Right-hand sides
+   */
+  Mat<eT> solve(const Mat<eT> &B) const;
+
+  /**
+   * @brief True once a matrix has been factorized
+   */
+  bool factorized() const;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl;
+};
+
+typedef SparseSolverT<Real> SparseSolver;
+typedef SparseSolverT<cx_double> cxSparseSolver;
+
+#endif // SPARSESOLVER_H
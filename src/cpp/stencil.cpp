@@ -0,0 +1,165 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file stencil.cpp
+ *
+ * @brief Matrix-free kernels for banded 1-D mimetic operators
+ *
+ * @date 2024/10/15
+ */
+
+#include "stencil.h"
+#include "coefficients.h"
+#include <algorithm>
+#include <cassert>
+
+// Copies the nonzero column range of a few sparse rows into a dense block
+static void extract_block(const sp_mat &B, mat &block, uword &first) {
+  uword lo = B.n_cols;
+  uword hi = 0;
+
+  for (sp_mat::const_iterator it = B.begin(); it != B.end(); ++it) {
+    lo = std::min(lo, static_cast<uword>(it.col()));
+    hi = std::max(hi, static_cast<uword>(it.col()));
+  }
+
+  if (lo > hi) {
+    block.zeros(B.n_rows, 1);
+    first = 0;
+    return;
+  }
+
+  block = mat(B.cols(lo, hi));
+  first = lo;
+}
+
+// Dense boundary rows
+static void boundary_rows(const mat &block, uword first, uword r0,
+                          const Real *x, uword xs, Real *y, uword ys,
+                          uword lines, bool accumulate) {
+  for (uword r = 0; r < block.n_rows; ++r) {
+    Real *yr = y + (r0 + r) * ys;
+    if (!accumulate)
+      std::fill(yr, yr + lines, 0.0);
+    for (uword c = 0; c < block.n_cols; ++c) {
+      const Real a = block(r, c);
+      if (a == 0.0)
+        continue;
+      const Real *xc = x + (first + c) * xs;
+      for (uword l = 0; l < lines; ++l)
+        yr[l] += a * xc[l];
+    }
+  }
+}
+
+// Interior rows, W is known at compile time so the stencil loop unrolls
+template <int W>
+static void interior_rows(const Real *w, uword r0, uword r1, sword shift,
+                          const Real *x, uword xs, Real *y, uword ys,
+                          uword lines, bool accumulate) {
+  for (uword r = r0; r < r1; ++r) {
+    const Real *xr = x + static_cast<uword>(static_cast<sword>(r) + shift) * xs;
+    Real *yr = y + r * ys;
+    for (uword l = 0; l < lines; ++l) {
+      Real s = accumulate ? yr[l] : 0.0;
+      for (int t = 0; t < W; ++t)
+        s += w[t] * xr[t * xs + l];
+      yr[l] = s;
+    }
+  }
+}
+
+// Fallback for stencil widths without a specialization
+static void interior_rows(const Real *w, uword W, uword r0, uword r1,
+                          sword shift, const Real *x, uword xs, Real *y,
+                          uword ys, uword lines, bool accumulate) {
+  for (uword r = r0; r < r1; ++r) {
+    const Real *xr = x + static_cast<uword>(static_cast<sword>(r) + shift) * xs;
+    Real *yr = y + r * ys;
+    for (uword l = 0; l < lines; ++l) {
+      Real s = accumulate ? yr[l] : 0.0;
+      for (uword t = 0; t < W; ++t)
+        s += w[t] * xr[t * xs + l];
+      yr[l] = s;
+    }
+  }
+}
+
+Stencil::Stencil()
+    : n_rows(0), n_cols(0), shift(0), nb(0), top_col(0), bottom_col(0) {}
+
+Stencil::Stencil(const sp_mat &A, const std::vector<Real> &interior,
+                 sword shift, uword boundary)
+    : n_rows(A.n_rows), n_cols(A.n_cols), w(interior), shift(shift),
+      nb(boundary), top_col(0), bottom_col(0) {
+  assert(nb > 0 && 2 * nb <= n_rows);
+  assert(static_cast<sword>(nb) + shift >= 0);
+  assert(static_cast<sword>(n_rows - nb) + shift +
+             static_cast<sword>(w.size()) <=
+         static_cast<sword>(n_cols + 1));
+
+  sp_mat first_rows(A.rows(0, nb - 1));
+  sp_mat last_rows(A.rows(n_rows - nb, n_rows - 1));
+
+  extract_block(first_rows, top, top_col);
+  extract_block(last_rows, bottom, bottom_col);
+}
+
+void Stencil::apply(const Real *x, uword x_stride, Real *y, uword y_stride,
+                    uword lines, bool accumulate) const {
+  const uword r0 = nb;
+  const uword r1 = n_rows - nb;
+
+  boundary_rows(top, top_col, 0, x, x_stride, y, y_stride, lines, accumulate);
+
+  switch (w.size()) {
+  case 2:
+    interior_rows<2>(w.data(), r0, r1, shift, x, x_stride, y, y_stride, lines,
+                     accumulate);
+    break;
+  case 3:
+    interior_rows<3>(w.data(), r0, r1, shift, x, x_stride, y, y_stride, lines,
+                     accumulate);
+    break;
+  case 4:
+    interior_rows<4>(w.data(), r0, r1, shift, x, x_stride, y, y_stride, lines,
+                     accumulate);
+    break;
+  case 6:
+    interior_rows<6>(w.data(), r0, r1, shift, x, x_stride, y, y_stride, lines,
+                     accumulate);
+    break;
+  case 7:
+    interior_rows<7>(w.data(), r0, r1, shift, x, x_stride, y, y_stride, lines,
+                     accumulate);
+    break;
+  case 8:
+    interior_rows<8>(w.data(), r0, r1, shift, x, x_stride, y, y_stride, lines,
+                     accumulate);
+    break;
+  case 11:
+    interior_rows<11>(w.data(), r0, r1, shift, x, x_stride, y, y_stride, lines,
+                      accumulate);
+    break;
+  default:
+    interior_rows(w.data(), w.size(), r0, r1, shift, x, x_stride, y, y_stride,
+                  lines, accumulate);
+  }
+
+  boundary_rows(bottom, bottom_col, r1, x, x_stride, y, y_stride, lines,
+                accumulate);
+}
+
+const std::vector<Real> &Stencil::weights() const { return w; }
+
+std::vector<Real> Stencil::interior(u16 k) {
+  assert(!(k % 2));
+  assert(k > 1 && k < 9);
+
+  const Real *w = Coefficients::interior(k);
+  return std::vector<Real>(w, w + k);
+}
@@ -0,0 +1,156 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file stencil.h
+ *
+ * @brief Matrix-free kernels for banded 1-D mimetic operators
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef STENCIL_H
+#define STENCIL_H
+
+#include "utils.h"
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Matrix-free representation of a banded 1-D mimetic operator
+ *
+ * Every row away from the ends applies the same interior stencil, so only
+ * the stencil coefficients are stored for them. The few rows near each end
+ * are copied from the assembled operator into small dense blocks.
+ */
+class Stencil {
+
+public:
+  /**
+   * @brief Empty kernel, only useful as a placeholder
+   */
+  Stencil();
+
+  /**
+   * @brief Builds the kernel of an assembled 1-D operator
+   *
+   * @param A Assembled 1-D operator
+   * @param interior Interior stencil, already scaled by the grid spacing
+   * @param shift Column of the first interior coefficient relative to the row
+   * @param boundary Number of rows at each end that use the assembled values
+   */
+  Stencil(const sp_mat &A, const std::vector<Real> &interior, sword shift,
+          uword boundary);
+
+  /**
+   * @brief Applies the operator to one or more interleaved lines
+   *
+   * Line l reads x[c * x_stride + l] for c < n_cols and writes
+   * y[r * y_stride + l] for r < n_rows.
+   *
+   * @param x Input values
+   * @param x_stride Distance between consecutive entries of a line in x
+   * @param y Output values
+   * @param y_stride Distance between consecutive entries of a line in y
+   * @param lines Number of contiguous lines processed together
+   * @param accumulate Adds to y instead of overwriting it
+   */
+  void apply(const Real *x, uword x_stride, Real *y, uword y_stride,
+             uword lines, bool accumulate) const;
+
+  /**
+   * @brief Interior stencil coefficients
+   */
+  const std::vector<Real> &weights() const;
+
+  /**
+   * @brief Unscaled interior stencil shared by the k-th order gradient and
+   * divergence
+   *
+   * @param k Order of accuracy
+   */
+  static std::vector<Real> interior(u16 k);
+
+  uword n_rows; ///< Rows of the 1-D operator
+  uword n_cols; ///< Columns of the 1-D operator
+
+private:
+  std::vector<Real> w;
+  sword shift;
+  uword nb;
+  mat top, bottom;
+  uword top_col, bottom_col;
+};
+
+/**
+ * @brief Sparse operator that also keeps matrix-free kernels of itself
+ *
+ * Base of Gradient, Divergence and Laplacian. Assignment and compound
+ * assignment work as for sp_mat, but may change any value, so they drop the
+ * kernels; assigning an assembled sp_mat temporary moves it in. The kernels
+ * are also ignored once the number of nonzeros differs from the assembled
+ * one. Element writes that keep the sparsity pattern, e.g. A(i, j) = v,
+ * A.diag() += s or A.transform(f), are not detected: after those, assign
+ * the operator to itself (A = sp_mat(A)) before calling apply().
+ */
+template <typename Derived> class StencilOperator : public sp_mat {
+
+public:
+  template <typename T> Derived &operator=(const T &X) {
+    sp_mat::operator=(X);
+    return invalidate();
+  }
+
+  Derived &operator=(sp_mat &&X) {
+    sp_mat::operator=(std::move(X));
+    return invalidate();
+  }
+
+  template <typename T> Derived &operator+=(const T &X) {
+    sp_mat::operator+=(X);
+    return invalidate();
+  }
+
+  template <typename T> Derived &operator-=(const T &X) {
+    sp_mat::operator-=(X);
+    return invalidate();
+  }
+
+  template <typename T> Derived &operator*=(const T &X) {
+    sp_mat::operator*=(X);
+    return invalidate();
+  }
+
+  template <typename T> Derived &operator/=(const T &X) {
+    sp_mat::operator/=(X);
+    return invalidate();
+  }
+
+  template <typename T> Derived &operator%=(const T &X) {
+    sp_mat::operator%=(X);
+    return invalidate();
+  }
+
+protected:
+  /**
+   * @brief True while the kernels still describe the matrix
+   */
+  bool matrix_free() const {
+    sync();
+    return !kernels.empty() && n_nonzero == assembled_nnz;
+  }
+
+  std::vector<Stencil> kernels;
+  uword assembled_nnz = 0;
+
+private:
+  Derived &invalidate() {
+    kernels.clear();
+    return static_cast<Derived &>(*this);
+  }
+};
+
+#endif // STENCIL_H
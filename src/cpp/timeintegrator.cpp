@@ -0,0 +1,157 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file timeintegrator.cpp
+ *
+ * @brief Explicit time integrators with preallocated stages
+ *
+ * @date 2024/10/15
+ */
+
+#include "timeintegrator.h"
+#include "csrmatrix.h"
+#include <cassert>
+#include <memory>
+
+// y = a * x + b * z, y may alias x or z
+static void combine(vec &y, Real a, const vec &x, Real b, const vec &z) {
+  Real *py = y.memptr();
+  const Real *px = x.memptr();
+  const Real *pz = z.memptr();
+  const sword n = y.n_elem;
+
+#pragma omp parallel for schedule(static)
+  for (sword i = 0; i < n; ++i)
+    py[i] = a * px[i] + b * pz[i];
+}
+
+// y = a * x + b * z + c * w, y may alias any operand
+static void combine(vec &y, Real a, const vec &x, Real b, const vec &z,
+                    Real c, const vec &w) {
+  Real *py = y.memptr();
+  const Real *px = x.memptr();
+  const Real *pz = z.memptr();
+  const Real *pw = w.memptr();
+  const sword n = y.n_elem;
+
+#pragma omp parallel for schedule(static)
+  for (sword i = 0; i < n; ++i)
+    py[i] = a * px[i] + b * pz[i] + c * pw[i];
+}
+
+// Converted once, so every evaluation runs row-parallel
+static std::function<void(Real, const vec &, vec &)> linear(const sp_mat &A) {
+  assert(A.n_rows == A.n_cols);
+  auto csr = std::make_shared<CSRMatrix>(A);
+  return [csr](Real, const vec &u, vec &y) { csr->apply(u, y); };
+}
+
+TimeIntegrator::TimeIntegrator(TimeScheme scheme, const RightHandSide &f,
+                               uword n)
+    : scheme(scheme), f(f), n(n) {
+  uword stages = 1;
+  switch (scheme) {
+  case TimeScheme::Euler:
+    stages = 1;
+    break;
+  case TimeScheme::SSPRK2:
+  case TimeScheme::SSPRK3:
+    stages = 2;
+    break;
+  case TimeScheme::RK4:
+    stages = 5;
+    break;
+  }
+
+  k.resize(stages);
+  for (vec &v : k)
+    v.zeros(n);
+}
+
+TimeIntegrator::TimeIntegrator(TimeScheme scheme, const sp_mat &A)
+    : TimeIntegrator(scheme, linear(A), A.n_rows) {}
+
+void TimeIntegrator::step(vec &u, Real t, Real dt) {
+  assert(u.n_elem == n);
+
+  switch (scheme) {
+  case TimeScheme::Euler:
+    f(t, u, k[0]);
+    combine(u, 1.0, u, dt, k[0]);
+    break;
+
+  case TimeScheme::SSPRK2: {
+    vec &s = k[1];
+    f(t, u, k[0]);
+    combine(s, 1.0, u, dt, k[0]);
+    f(t + dt, s, k[0]);
+    combine(u, 0.5, u, 0.5, s, 0.5 * dt, k[0]);
+    break;
+  }
+
+  case TimeScheme::SSPRK3: {
+    vec &s = k[1];
+    f(t, u, k[0]);
+    combine(s, 1.0, u, dt, k[0]);
+    f(t + dt, s, k[0]);
+    combine(s, 0.75, u, 0.25, s, 0.25 * dt, k[0]);
+    f(t + 0.5 * dt, s, k[0]);
+    combine(u, 1.0 / 3.0, u, 2.0 / 3.0, s, 2.0 / 3.0 * dt, k[0]);
+    break;
+  }
+
+  case TimeScheme::RK4: {
+    vec &s = k[4];
+    f(t, u, k[0]);
+    combine(s, 1.0, u, 0.5 * dt, k[0]);
+    f(t + 0.5 * dt, s, k[1]);
+    combine(s, 1.0, u, 0.5 * dt, k[1]);
+    f(t + 0.5 * dt, s, k[2]);
+    combine(s, 1.0, u, dt, k[2]);
+    f(t + dt, s, k[3]);
+
+    // u += dt/6 * (k0 + 2 k1 + 2 k2 + k3) in one pass
+    Real *pu = u.memptr();
+    const Real *k0 = k[0].memptr(), *k1 = k[1].memptr();
+    const Real *k2 = k[2].memptr(), *k3 = k[3].memptr();
+    const Real h = dt / 6.0;
+    const sword m = n;
+
+#pragma omp parallel for schedule(static)
+    for (sword i = 0; i < m; ++i)
+      pu[i] += h * (k0[i] + 2.0 * (k1[i] + k2[i]) + k3[i]);
+    break;
+  }
+  }
+}
+
+Real TimeIntegrator::advance(vec &u, Real t, Real dt, uword steps) {
+  for (uword s = 0; s < steps; ++s, t += dt)
+    step(u, t, dt);
+  return t;
+}
+
+Verlet::Verlet(const Acceleration &a, uword n) : a(a), n(n), acc(n) {
+  acc.zeros();
+}
+
+Verlet::Verlet(const sp_mat &A) : Verlet(linear(A), A.n_rows) {}
+
+void Verlet::step(vec &u, vec &v, Real t, Real dt) {
+  assert(u.n_elem == n && v.n_elem == n);
+
+  combine(u, 1.0, u, 0.5 * dt, v);
+  a(t + 0.5 * dt, u, acc);
+  combine(v, 1.0, v, dt, acc);
+  combine(u, 1.0, u, 0.5 * dt, v);
+}
+
+Real Verlet::advance(vec &u, vec &v, Real t, Real dt, uword steps) {
+  for (uword s = 0; s < steps; ++s, t += dt)
+    step(u, v, t, dt);
+  return t;
+}
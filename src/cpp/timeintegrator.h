@@ -0,0 +1,136 @@
+/*
+* SPDX-License-Identifier: GPL-3.0-or-later
+* © 2008-2024 San Diego State University Research Foundation (SDSURF).
+* See LICENSE file or https://www.gnu.org/licenses/gpl-3.0.html for details.
+*/
+
+/*
+ * @file timeintegrator.h
+ *
+ * @brief Explicit time integrators with preallocated stages
+ *
+ * @date 2024/10/15
+ */
+
+#ifndef TIMEINTEGRATOR_H
+#define TIMEINTEGRATOR_H
+
+#include "utils.h"
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Right-hand side of du/dt = f(t, u)
+ *
+ * Writes f(t, u) into dudt, which already has the size of u, so a callback
+ * that fills it in place allocates nothing.
+ */
+typedef std::function<void(Real t, const vec &u, vec &dudt)> RightHandSide;
+
+/**
+ * @brief Explicit Runge-Kutta schemes of TimeIntegrator
+ */
+enum class TimeScheme {
+  Euler,  ///< Forward Euler, first order
+  SSPRK2, ///< Strong-stability-preserving RK2 (Heun)
+  SSPRK3, ///< Strong-stability-preserving RK3 (Shu-Osher)
+  RK4     ///< Classic fourth-order Runge-Kutta
+};
+
+/**
+ * @brief Explicit integrator of du/dt = f(t, u)
+ *
+ * Every stage vector is allocated once, in the constructor, and each step
+ * updates u in place with fused loops that combine all the terms of a stage
+ * in one pass, so long runs do not allocate.
+ *
+ * @code
+ * TimeIntegrator rk(TimeScheme::RK4, L); // du/dt = L * u
+ * rk.advance(u, 0.0, dt, steps);
+ * @endcode
+ */
+class TimeIntegrator {
+
+public:
+  /**
+   * @param scheme Runge-Kutta scheme
+   * @param f Right-hand side
+   * @param n Number of unknowns
+   */
+  TimeIntegrator(TimeScheme scheme, const RightHandSide &f, uword n);
+
+  /**
+   * @brief Integrator of the linear system du/dt = A * u
+   *
+   * A is copied into a CSRMatrix, so every stage runs row-parallel.
+   *
+   * @param scheme Runge-Kutta scheme
+   * @param A Square operator, e.g. a Laplacian with its boundary conditions
+   */
+  TimeIntegrator(TimeScheme scheme, const sp_mat &A);
+
+  /**
+   * @brief Advances u from t to t + dt, in place
+   */
+  void step(vec &u, Real t, Real dt);
+
+  /**
+   * @brief Takes a number of steps of size dt from time t
+   *
+   * @return Final time
+   */
+  Real advance(vec &u, Real t, Real dt, uword steps);
+
+private:
+  TimeScheme scheme;
+  RightHandSide f;
+  uword n;
+  std::vector<vec> k; // Stage slopes and intermediate states
+};
+
+/**
+ * @brief Acceleration of d2u/dt2 = a(t, u), written into acc
+ */
+typedef std::function<void(Real t, const vec &u, vec &acc)> Acceleration;
+
+/**
+ * @brief Position Verlet (leapfrog) integrator of d2u/dt2 = a(t, u)
+ *
+ * Half drift, kick, half drift: second order, time reversible and
+ * symplectic, as used by the wave examples.
+ */
+class Verlet {
+
+public:
+  /**
+   * @param a Acceleration
+   * @param n Number of unknowns
+   */
+  Verlet(const Acceleration &a, uword n);
+
+  /**
+   * @brief Integrator of the linear system d2u/dt2 = A * u
+   *
+   * @param A Square operator, copied into a CSRMatrix
+   */
+  explicit Verlet(const sp_mat &A);
+
+  /**
+   * @brief Advances position u and velocity v from t to t + dt, in place
+   */
+  void step(vec &u, vec &v, Real t, Real dt);
+
+  /**
+   * @brief Takes a number of steps of size dt from time t
+   *
+   * @return Final time
+   */
+  Real advance(vec &u, vec &v, Real t, Real dt, uword steps);
+
+private:
+  Acceleration a;
+  uword n;
+  vec acc;
+};
+
+#endif // TIMEINTEGRATOR_H
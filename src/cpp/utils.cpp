@@ -16,36 +16,15 @@
  */
 
 #include "utils.h"
+#include <algorithm>
 #include <cassert>
 
 #ifdef EIGEN
-#include <eigen3/Eigen/SparseLU>
+#include "sparsesolver.h"
 
 vec Utils::spsolve_eigen(const sp_mat &A, const vec &b) {
-  Eigen::SparseMatrix<Real> eigen_A(A.n_rows, A.n_cols);
-  std::vector<Eigen::Triplet<Real>> triplets;
-  Eigen::SparseLU<Eigen::SparseMatrix<Real>, Eigen::COLAMDOrdering<int>> solver;
-
-  Eigen::VectorXd eigen_x(A.n_rows);
-  triplets.reserve(5 * A.n_rows);
-
-  auto it = A.begin();
-  while (it != A.end()) {
-    triplets.push_back(Eigen::Triplet<Real>(it.row(), it.col(), *it));
-    ++it;
-  }
-
-  eigen_A.setFromTriplets(triplets.begin(), triplets.end());
-  triplets.clear();
-
-  auto b_ = conv_to<std::vector<Real>>::from(b);
-  Eigen::Map<Eigen::VectorXd> eigen_b(b_.data(), b_.size());
-
-  solver.analyzePattern(eigen_A);
-  solver.factorize(eigen_A);
-  eigen_x = solver.solve(eigen_b);
-
-  return vec(eigen_x.data(), eigen_x.size());
+  SparseSolver solver(A);
+  return solver.solve(b);
 }
 #endif
 
@@ -68,103 +47,301 @@ sp_mat Utils::spkron(const sp_mat &A, const sp_mat &B)
 */
 
 sp_mat Utils::spkron(const sp_mat &A, const sp_mat &B) {
-  sp_mat::const_iterator itA = A.begin();
-  sp_mat::const_iterator endA = A.end();
-  sp_mat::const_iterator itB = B.begin();
-  sp_mat::const_iterator endB = B.end();
-  u32 j = 0;
-
-  vec a = nonzeros(A);
-  vec b = nonzeros(B);
-
-  umat locations(2, a.n_elem * b.n_elem);
-  vec values(a.n_elem * b.n_elem);
-
-  while (itA != endA) {
-    while (itB != endB) {
-      locations(0, j) = itA.row() * B.n_rows + itB.row();
-      locations(1, j) = itA.col() * B.n_cols + itB.col();
-      values(j) = (*itA) * (*itB);
-      ++j;
-      ++itB;
+  A.sync();
+  B.sync();
+
+  const uword n_cols = A.n_cols * B.n_cols;
+
+  // Column ja * B.n_cols + jb holds nnz(A(:, ja)) * nnz(B(:, jb)) entries
+  std::vector<uword> colptr(n_cols + 1, 0);
+  for (uword ja = 0; ja < A.n_cols; ++ja) {
+    const uword na = A.col_ptrs[ja + 1] - A.col_ptrs[ja];
+    for (uword jb = 0; jb < B.n_cols; ++jb) {
+      const uword j = ja * B.n_cols + jb;
+      colptr[j + 1] = colptr[j] + na * (B.col_ptrs[jb + 1] - B.col_ptrs[jb]);
     }
-
-    ++itA;
-    itB = B.begin();
   }
 
-  sp_mat result(locations, values, A.n_rows * B.n_rows, A.n_cols * B.n_cols,
-                true);
+  sp_mat result(A.n_rows * B.n_rows, n_cols);
+  result.mem_resize(colptr[n_cols]);
+
+  for (uword j = 0; j <= n_cols; ++j)
+    access::rw(result.col_ptrs[j]) = colptr[j];
+
+  // Rows of A are sorted within a column and every block of B rows is
+  // below the next one, so each column comes out sorted
+#pragma omp parallel for schedule(static)
+  for (sword ja = 0; ja < static_cast<sword>(A.n_cols); ++ja) {
+    for (uword jb = 0; jb < B.n_cols; ++jb) {
+      uword p = colptr[ja * B.n_cols + jb];
+      for (uword pa = A.col_ptrs[ja]; pa < A.col_ptrs[ja + 1]; ++pa) {
+        const uword r = A.row_indices[pa] * B.n_rows;
+        const Real a = A.values[pa];
+        for (uword pb = B.col_ptrs[jb]; pb < B.col_ptrs[jb + 1]; ++pb) {
+          access::rw(result.row_indices[p]) = r + B.row_indices[pb];
+          access::rw(result.values[p]) = a * B.values[pb];
+          ++p;
+        }
+      }
+    }
+  }
 
   return result;
 }
 
+KronTerm::KronTerm(const sp_mat &A, const sp_mat &B, uword row_offset,
+                   uword col_offset)
+    : factors{&A, &B}, row_offset(row_offset), col_offset(col_offset),
+      n_rows(A.n_rows * B.n_rows), n_cols(A.n_cols * B.n_cols) {}
+
+KronTerm::KronTerm(const sp_mat &A, const sp_mat &B, const sp_mat &C,
+                   uword row_offset, uword col_offset)
+    : factors{&A, &B, &C}, row_offset(row_offset), col_offset(col_offset),
+      n_rows(A.n_rows * B.n_rows * C.n_rows),
+      n_cols(A.n_cols * B.n_cols * C.n_cols) {}
+
+// Entries of one column of a Kronecker product, factor by factor
+static void kron_entries(const KronTerm &t, const uword *cols, uword level,
+                         uword row, Real value,
+                         std::vector<std::pair<uword, Real>> &buf) {
+  if (level == t.factors.size()) {
+    buf.push_back(std::make_pair(t.row_offset + row, value));
+    return;
+  }
+
+  const sp_mat &F = *t.factors[level];
+  for (uword p = F.col_ptrs[cols[level]]; p < F.col_ptrs[cols[level] + 1];
+       ++p)
+    kron_entries(t, cols, level + 1, row * F.n_rows + F.row_indices[p],
+                 value * F.values[p], buf);
+}
 
-sp_mat Utils::spjoin_rows(const sp_mat &A, const sp_mat &B) {
-  sp_mat::const_iterator itA = A.begin();
-  sp_mat::const_iterator endA = A.end();
-  sp_mat::const_iterator itB = B.begin();
-  sp_mat::const_iterator endB = B.end();
-  u32 j = 0;
+// Column j of a sum of Kronecker products, sorted by row without duplicates
+static void kron_column(const std::vector<KronTerm> &terms, uword j,
+                        std::vector<std::pair<uword, Real>> &buf) {
+  uword cols[3];
+  buf.clear();
 
-  vec a = nonzeros(A);
-  vec b = nonzeros(B);
+  for (const KronTerm &t : terms) {
+    if (j < t.col_offset || j >= t.col_offset + t.n_cols)
+      continue;
 
-  umat locations(2, a.n_elem + b.n_elem);
-  vec values(a.n_elem + b.n_elem);
+    uword c = j - t.col_offset;
+    for (uword l = t.factors.size(); l-- > 0;) {
+      cols[l] = c % t.factors[l]->n_cols;
+      c /= t.factors[l]->n_cols;
+    }
 
-  while (itA != endA) {
-    locations(0, j) = itA.row();
-    locations(1, j) = itA.col();
-    values(j) = (*itA);
-    ++itA;
-    ++j;
+    kron_entries(t, cols, 0, 0, 1.0, buf);
   }
 
-  while (itB != endB) {
-    locations(0, j) = itB.row();
-    locations(1, j) = itB.col() + A.n_cols;
-    values(j) = (*itB);
-    ++itB;
-    ++j;
+  // Stable, so duplicates are summed in term order and equal stencils get
+  // bit-identical coefficients in every row
+  std::stable_sort(buf.begin(), buf.end(),
+                   [](const std::pair<uword, Real> &a,
+                      const std::pair<uword, Real> &b) {
+                     return a.first < b.first;
+                   });
+
+  uword n = 0;
+  for (uword p = 0; p < buf.size(); ++p) {
+    if (n > 0 && buf[n - 1].first == buf[p].first)
+      buf[n - 1].second += buf[p].second;
+    else
+      buf[n++] = buf[p];
   }
+  buf.resize(n);
 
-  sp_mat result(locations, values, A.n_rows, A.n_cols + B.n_cols, true);
+  buf.erase(std::remove_if(buf.begin(), buf.end(),
+                           [](const std::pair<uword, Real> &e) {
+                             return e.second == 0.0;
+                           }),
+            buf.end());
+}
+
+sp_mat Utils::spkron_sum(const std::vector<KronTerm> &terms, uword n_rows,
+                         uword n_cols) {
+  for (const KronTerm &t : terms) {
+    assert(t.factors.size() <= 3);
+    assert(t.row_offset + t.n_rows <= n_rows);
+    assert(t.col_offset + t.n_cols <= n_cols);
+    for (const sp_mat *F : t.factors)
+      F->sync();
+  }
+
+  // First pass counts the entries of every column
+  std::vector<uword> colptr(n_cols + 1, 0);
+
+#pragma omp parallel
+  {
+    std::vector<std::pair<uword, Real>> buf;
+#pragma omp for schedule(static)
+    for (sword j = 0; j < static_cast<sword>(n_cols); ++j) {
+      kron_column(terms, j, buf);
+      colptr[j + 1] = buf.size();
+    }
+  }
+
+  for (uword j = 0; j < n_cols; ++j)
+    colptr[j + 1] += colptr[j];
+
+  // Second pass writes straight into the storage of the result
+  sp_mat result(n_rows, n_cols);
+  result.mem_resize(colptr[n_cols]);
+
+  for (uword j = 0; j <= n_cols; ++j)
+    access::rw(result.col_ptrs[j]) = colptr[j];
+
+#pragma omp parallel
+  {
+    std::vector<std::pair<uword, Real>> buf;
+#pragma omp for schedule(static)
+    for (sword j = 0; j < static_cast<sword>(n_cols); ++j) {
+      kron_column(terms, j, buf);
+      uword p = colptr[j];
+      for (const std::pair<uword, Real> &e : buf) {
+        access::rw(result.row_indices[p]) = e.first;
+        access::rw(result.values[p]) = e.second;
+        ++p;
+      }
+    }
+  }
 
   return result;
 }
 
+sp_mat Utils::spmerge(const sp_mat &A, const sp_mat &B,
+                      std::vector<uword> *b_pos) {
+  assert(A.n_rows == B.n_rows && A.n_cols == B.n_cols);
+
+  A.sync();
+  B.sync();
+
+  // Calls emit(row, value, q) for every row of column j of the result,
+  // where q is the position in B of the entry it takes, or B.n_nonzero
+  auto merge = [&A, &B](uword j, auto emit) {
+    uword p = A.col_ptrs[j], q = B.col_ptrs[j];
+    const uword p_end = A.col_ptrs[j + 1], q_end = B.col_ptrs[j + 1];
+
+    while (p < p_end || q < q_end) {
+      if (q == q_end || (p < p_end && A.row_indices[p] < B.row_indices[q])) {
+        emit(A.row_indices[p], A.values[p], B.n_nonzero);
+        ++p;
+      } else if (p == p_end || B.row_indices[q] < A.row_indices[p]) {
+        emit(B.row_indices[q], B.values[q], q);
+        ++q;
+      } else {
+        emit(A.row_indices[p], A.values[p] + B.values[q], q);
+        ++p;
+        ++q;
+      }
+    }
+  };
+
+  // First pass sizes the merged columns, the second writes them
+  std::vector<uword> colptr(A.n_cols + 1, 0);
+  for (uword j = 0; j < A.n_cols; ++j) {
+    uword count = 0;
+    merge(j, [&count](uword, Real, uword) { ++count; });
+    colptr[j + 1] = colptr[j] + count;
+  }
 
-sp_mat Utils::spjoin_cols(const sp_mat &A, const sp_mat &B) {
-  sp_mat::const_iterator itA = A.begin();
-  sp_mat::const_iterator endA = A.end();
-  sp_mat::const_iterator itB = B.begin();
-  sp_mat::const_iterator endB = B.end();
-  u32 j = 0;
+  sp_mat result(A.n_rows, A.n_cols);
+  result.mem_resize(colptr[A.n_cols]);
 
-  vec a = nonzeros(A);
-  vec b = nonzeros(B);
+  for (uword j = 0; j <= A.n_cols; ++j)
+    access::rw(result.col_ptrs[j]) = colptr[j];
 
-  umat locations(2, a.n_elem + b.n_elem);
-  vec values(a.n_elem + b.n_elem);
+  if (b_pos)
+    b_pos->assign(B.n_nonzero, 0);
 
-  while (itA != endA) {
-    locations(0, j) = itA.row();
-    locations(1, j) = itA.col();
-    values(j) = (*itA);
-    ++itA;
-    ++j;
+  for (uword j = 0; j < A.n_cols; ++j) {
+    uword p = colptr[j];
+    merge(j, [&result, &p, b_pos, &B](uword r, Real v, uword q) {
+      access::rw(result.row_indices[p]) = r;
+      access::rw(result.values[p]) = v;
+      if (b_pos && q < B.n_nonzero)
+        (*b_pos)[q] = p;
+      ++p;
+    });
   }
 
-  while (itB != endB) {
-    locations(0, j) = itB.row() + A.n_rows;
-    locations(1, j) = itB.col();
-    values(j) = (*itB);
-    ++itB;
-    ++j;
+  return result;
+}
+
+sp_mat Utils::spjoin_rows(const sp_mat &A, const sp_mat &B) {
+  return spjoin_rows({&A, &B});
+}
+
+sp_mat Utils::spjoin_rows(const std::vector<const sp_mat *> &blocks) {
+  assert(!blocks.empty());
+
+  const uword n_rows = blocks[0]->n_rows;
+  uword n_cols = 0;
+  uword nnz = 0;
+  for (const sp_mat *M : blocks) {
+    assert(M->n_rows == n_rows);
+    M->sync();
+    n_cols += M->n_cols;
+    nnz += M->n_nonzero;
   }
 
-  sp_mat result(locations, values, A.n_rows + B.n_rows, A.n_cols, true);
+  sp_mat result(n_rows, n_cols);
+  result.mem_resize(nnz);
+
+  // Column arrays are appended, shifting the pointers of each block
+  uword j = 0;
+  uword p = 0;
+  for (const sp_mat *M : blocks) {
+    for (uword c = 0; c < M->n_cols; ++c)
+      access::rw(result.col_ptrs[j + c]) = p + M->col_ptrs[c];
+    std::copy(M->row_indices, M->row_indices + M->n_nonzero,
+              access::rwp(result.row_indices) + p);
+    std::copy(M->values, M->values + M->n_nonzero,
+              access::rwp(result.values) + p);
+    j += M->n_cols;
+    p += M->n_nonzero;
+  }
+  access::rw(result.col_ptrs[n_cols]) = nnz;
+
+  return result;
+}
+
+sp_mat Utils::spjoin_cols(const sp_mat &A, const sp_mat &B) {
+  return spjoin_cols({&A, &B});
+}
+
+sp_mat Utils::spjoin_cols(const std::vector<const sp_mat *> &blocks) {
+  assert(!blocks.empty());
+
+  const uword n_cols = blocks[0]->n_cols;
+  uword n_rows = 0;
+  uword nnz = 0;
+  for (const sp_mat *M : blocks) {
+    assert(M->n_cols == n_cols);
+    M->sync();
+    n_rows += M->n_rows;
+    nnz += M->n_nonzero;
+  }
+
+  sp_mat result(n_rows, n_cols);
+  result.mem_resize(nnz);
+
+  // Every block lies below the previous one, so column c is the blocks'
+  // columns c one after the other, already sorted
+  uword p = 0;
+  for (uword c = 0; c < n_cols; ++c) {
+    access::rw(result.col_ptrs[c]) = p;
+    uword offset = 0;
+    for (const sp_mat *M : blocks) {
+      for (uword q = M->col_ptrs[c]; q < M->col_ptrs[c + 1]; ++q, ++p) {
+        access::rw(result.row_indices[p]) = M->row_indices[q] + offset;
+        access::rw(result.values[p]) = M->values[q];
+      }
+      offset += M->n_rows;
+    }
+  }
+  access::rw(result.col_ptrs[n_cols]) = nnz;
 
   return result;
 }
@@ -244,3 +421,74 @@ double Utils::trapz(const vec &x, const vec &y) {
   return 0.5 * sum;
 }
 
+
+
+Triplets::Triplets(uword n_rows, uword n_cols, uword capacity)
+    : n_rows(n_rows), n_cols(n_cols) {
+  rows.reserve(capacity);
+  cols.reserve(capacity);
+  values.reserve(capacity);
+}
+
+Real &Triplets::at(uword r, uword c) {
+  assert(r < n_rows && c < n_cols);
+  rows.push_back(r);
+  cols.push_back(c);
+  values.push_back(0.0);
+  return values.back();
+}
+
+sp_mat Triplets::assemble(Real scale) const {
+  const uword nnz = values.size();
+
+  // Counting sort by column
+  uvec colptr(n_cols + 1, fill::zeros);
+  for (uword p = 0; p < nnz; ++p)
+    ++colptr(cols[p] + 1);
+  for (uword c = 0; c < n_cols; ++c)
+    colptr(c + 1) += colptr(c);
+
+  std::vector<uword> next(colptr.begin(), colptr.end() - 1);
+  std::vector<uword> order(nnz);
+  for (uword p = 0; p < nnz; ++p)
+    order[next[cols[p]]++] = p;
+
+  // Rows within a column are few, so an insertion sort is enough
+  for (uword c = 0; c < n_cols; ++c) {
+    for (uword p = colptr(c) + 1; p < colptr(c + 1); ++p) {
+      uword e = order[p];
+      uword q = p;
+      while (q > colptr(c) && rows[order[q - 1]] > rows[e]) {
+        order[q] = order[q - 1];
+        --q;
+      }
+      order[q] = e;
+    }
+  }
+
+  // Merge duplicates
+  uvec rowind(nnz);
+  vec vals(nnz);
+  uword j = 0;
+  uword start = 0;
+  for (uword c = 0; c < n_cols; ++c) {
+    const uword end = colptr(c + 1);
+    for (uword p = start; p < end; ++p) {
+      const uword e = order[p];
+      if (j > colptr(c) && rowind(j - 1) == rows[e]) {
+        vals(j - 1) += scale * values[e];
+      } else {
+        rowind(j) = rows[e];
+        vals(j) = scale * values[e];
+        ++j;
+      }
+    }
+    start = end;
+    colptr(c + 1) = j;
+  }
+
+  rowind.resize(j);
+  vals.resize(j);
+
+  return sp_mat(rowind, colptr, vals, n_rows, n_cols);
+}
@@ -17,10 +17,45 @@
 #define UTILS_H
 
 #include <armadillo>
+#include <vector>
 
 using Real = double;
 using namespace arma;
 
+/**
+ * @brief One term of a sum of Kronecker products
+ *
+ * Represents kron(A, B) or kron(A, kron(B, C)) placed at a block offset of a
+ * larger matrix. The factors are referenced, not copied, so they must outlive
+ * the term.
+ */
+struct KronTerm {
+  /**
+   * @param A Outer factor
+   * @param B Inner factor
+   * @param row_offset First row of the block in the assembled matrix
+   * @param col_offset First column of the block in the assembled matrix
+   */
+  KronTerm(const sp_mat &A, const sp_mat &B, uword row_offset = 0,
+           uword col_offset = 0);
+
+  /**
+   * @param A Outer factor
+   * @param B Middle factor
+   * @param C Inner factor
+   * @param row_offset First row of the block in the assembled matrix
+   * @param col_offset First column of the block in the assembled matrix
+   */
+  KronTerm(const sp_mat &A, const sp_mat &B, const sp_mat &C,
+           uword row_offset = 0, uword col_offset = 0);
+
+  std::vector<const sp_mat *> factors; ///< Outermost factor first
+  uword row_offset;
+  uword col_offset;
+  uword n_rows; ///< Rows of the Kronecker product
+  uword n_cols; ///< Columns of the Kronecker product
+};
+
 /**
  * @brief Utility Functions
  *
@@ -31,6 +66,10 @@ public:
   /**
   * @brief A wrappper for implementing a sparse Kroenecker product.
   *
+  * The column pointers of the result follow from the column counts of A and
+  * B, so the CSC arrays are written directly, in parallel over the columns
+  * of A, without sorting. Explicit zeros stored in A or B are kept.
+  *
   * @param A a sparse matrix
   * @param B a sparse matrix
   *
@@ -38,6 +77,36 @@ public:
   */
   static sp_mat spkron(const sp_mat &A, const sp_mat &B);
 
+  /**
+  * @brief Assembles a sum of Kronecker products directly in CSC form
+  *
+  * Each column of the result is generated from the columns of the 1-D
+  * factors, so no intermediate product is formed and the peak memory is the
+  * final matrix plus a small per-thread buffer. Overlapping terms are added
+  * together, so this covers both stacking blocks and summing them.
+  *
+  * @param terms Kronecker products and their block offsets
+  * @param n_rows Rows of the result
+  * @param n_cols Columns of the result
+  */
+  static sp_mat spkron_sum(const std::vector<KronTerm> &terms, uword n_rows,
+                           uword n_cols);
+
+  /**
+  * @brief A + B keeping every stored entry of both operands
+  *
+  * Unlike the Armadillo sum, entries that are or add up to zero stay in the
+  * result, so its sparsity pattern depends only on the operands' patterns.
+  * Both matrices are merged column by column in a single pass.
+  *
+  * @param A a sparse matrix
+  * @param B a sparse matrix of the same size
+  * @param b_pos If given, receives the position in the result's values of
+  * every stored entry of B, in B's storage order
+  */
+  static sp_mat spmerge(const sp_mat &A, const sp_mat &B,
+                        std::vector<uword> *b_pos = nullptr);
+
   /**
   *  @brief An in place operation for joining two matrices by rows
   *
@@ -48,6 +117,16 @@ public:
   */
   static sp_mat spjoin_rows(const sp_mat &A, const sp_mat &B);
 
+  /**
+  * @brief Joins any number of matrices by rows, [M0, M1, ...]
+  *
+  * The CSC arrays of the blocks are concatenated in one pass, with the
+  * column pointers shifted, so nothing is sorted.
+  *
+  * @param blocks Matrices with the same number of rows
+  */
+  static sp_mat spjoin_rows(const std::vector<const sp_mat *> &blocks);
+
   /**
   * @brief An in place operation for joining two matrices by columns
   *
@@ -58,6 +137,16 @@ public:
   */  
   static sp_mat spjoin_cols(const sp_mat &A, const sp_mat &B);
 
+  /**
+  * @brief Joins any number of matrices by columns, [M0; M1; ...]
+  *
+  * Each column of the result is the same column of every block in turn,
+  * which is already sorted, so the result is written in one pass.
+  *
+  * @param blocks Matrices with the same number of columns
+  */
+  static sp_mat spjoin_cols(const std::vector<const sp_mat *> &blocks);
+
   /**
   * @brief A wrappper for implementing a sparse solve using Eigen from SuperLU.
   *
@@ -116,4 +205,44 @@ public:
   static double trapz(const vec &x, const vec &y);
 };
 
+/**
+ * @brief Batch builder for sparse matrices
+ *
+ * Collects (row, col, value) entries and assembles the CSC arrays in a single
+ * O(nnz) pass, instead of paying an O(nnz) insertion for every sp_mat::at().
+ */
+class Triplets {
+public:
+  /**
+   * @brief Empty builder for a matrix of the given size
+   *
+   * @param n_rows Number of rows of the assembled matrix
+   * @param n_cols Number of columns of the assembled matrix
+   * @param capacity Expected number of entries
+   */
+  Triplets(uword n_rows, uword n_cols, uword capacity = 0);
+
+  /**
+   * @brief Appends an entry and returns a reference to its value
+   *
+   * Entries added more than once at the same location are summed.
+   *
+   * @param r Row index
+   * @param c Column index
+   */
+  Real &at(uword r, uword c);
+
+  /**
+   * @brief Assembles the collected entries into a sparse matrix
+   *
+   * @param scale Factor applied to every value
+   */
+  sp_mat assemble(Real scale = 1.0) const;
+
+private:
+  uword n_rows, n_cols;
+  std::vector<uword> rows, cols;
+  std::vector<Real> values;
+};
+
 #endif // UTILS_H
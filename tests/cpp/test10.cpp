@@ -0,0 +1,77 @@
+#include "mole.h"
+#include <gtest/gtest.h>
+
+TEST(SparseSolverTests, ReusesFactorization) {
+    int k = 4, m = 20;
+    Real dx = 1.0 / m;
+    sp_mat A = Laplacian(k, m, dx) + RobinBC(k, m, dx, 1, 1);
+
+    SparseSolver solver(A);
+    ASSERT_TRUE(solver.factorized());
+
+    for (int i = 0; i < 3; ++i) {
+        vec b = randu<vec>(A.n_rows);
+        vec x = solver.solve(b);
+        EXPECT_LT(norm(A * x - b, "inf"), 1e-9 * norm(b, "inf"));
+    }
+
+    // Same pattern, new values
+    sp_mat B = 2.0 * A;
+    solver.refactorize(B);
+    vec b = randu<vec>(A.n_rows);
+    EXPECT_LT(norm(B * solver.solve(b) - b, "inf"), 1e-9 * norm(b, "inf"));
+
+    // A different pattern is rejected
+    sp_mat C = A;
+    C(0, A.n_cols - 1) = 1.0;
+    EXPECT_THROW(solver.refactorize(C), std::invalid_argument);
+    EXPECT_THROW(solver.refactorize(sp_mat(A.submat(0, 0, 9, 9))),
+                 std::invalid_argument);
+}
+
+TEST(ParametricBCTests, MatchesRebuiltOperators) {
+    int k = 4, m = 12, n = 13, o = 14;
+    Real dx = 1.0 / m, dy = 1.0 / n, dz = 1.0 / o;
+
+    auto same = [](const sp_mat &A, const sp_mat &B) {
+        return norm(sp_mat(A - B), "fro") <= 1e-12 * (1 + norm(B, "fro"));
+    };
+
+    // Starting from pure Dirichlet still reserves the gradient rows
+    ParametricBC A(k, m, dx, n, dy, 1, 0);
+    EXPECT_TRUE(same(A, RobinBC(k, m, dx, n, dy, 1, 0)));
+    A.add(Laplacian(k, m, n, dx, dy));
+    const uword nnz = A.n_nonzero;
+
+    A.set_coefficients(2, 0.5);
+    EXPECT_EQ(A.n_nonzero, nnz);
+    EXPECT_TRUE(same(A, Laplacian(k, m, n, dx, dy) +
+                            RobinBC(k, m, dx, n, dy, 2, 0.5)));
+
+    // One pair per face reproduces MixedBC
+    std::vector<Real> dirichlet = {3}, neumann = {2}, robin = {1, 4};
+    A.set_coefficients(0, 3, 0);
+    A.set_coefficients(1, 0, 2);
+    A.set_coefficients(2, 1, 4);
+    A.set_coefficients(3, 3, 0);
+    EXPECT_EQ(A.n_nonzero, nnz);
+    EXPECT_TRUE(same(A, Laplacian(k, m, n, dx, dy) +
+                            MixedBC(k, m, dx, n, dy, "Dirichlet", dirichlet,
+                                    "Neumann", neumann, "Robin", robin,
+                                    "Dirichlet", dirichlet)));
+    EXPECT_THROW(A.set_coefficients(4, 1, 1), std::out_of_range);
+
+    // Numerical refactorization follows the new coefficients
+    A.set_coefficients(1, 1);
+    SparseSolver solver(A);
+    A.set_coefficients(5, 0.25);
+    solver.refactorize(A);
+    vec b = randu<vec>(A.n_rows);
+    EXPECT_LT(norm(A * solver.solve(b) - b, "inf"), 1e-9 * norm(b, "inf"));
+
+    ParametricBC C(k, m, dx, n, dy, o, dz, 1, 1);
+    C.add(Laplacian(k, m, n, o, dx, dy, dz));
+    C.set_coefficients(0.5, 3);
+    EXPECT_TRUE(same(C, Laplacian(k, m, n, o, dx, dy, dz) +
+                            RobinBC(k, m, dx, n, dy, o, dz, 0.5, 3)));
+}
@@ -0,0 +1,129 @@
+#include "mole.h"
+#include <gtest/gtest.h>
+
+// 2-D Poisson problem with Robin boundary conditions
+sp_mat poisson(int k, int m, int n) {
+    Real dx = 1.0 / m, dy = 1.0 / n;
+    return Laplacian(k, m, n, dx, dy) + RobinBC(k, m, dx, n, dy, 1, 1);
+}
+
+void expect_solved(const sp_mat &A, const vec &b, const vec &x,
+                   const KrylovResult &res, const KrylovOptions &opts) {
+    EXPECT_TRUE(res.converged);
+    EXPECT_EQ(res.history.size(), res.iterations);
+    EXPECT_LE(norm(b - A * x), 1.01 * opts.rtol * norm(b));
+}
+
+TEST(KrylovTests, NonsymmetricSolvers) {
+    sp_mat A = poisson(2, 20, 24);
+    vec b = randu<vec>(A.n_rows);
+    KrylovOptions opts;
+    opts.rtol = 1e-10;
+
+    ILU0Preconditioner ilu(A);
+    JacobiPreconditioner jacobi(A);
+    SSORPreconditioner ssor(A, 1.2);
+
+    vec x;
+    expect_solved(A, b, x, Krylov::bicgstab(A, b, x, &ilu, opts), opts);
+    x.reset();
+    expect_solved(A, b, x, Krylov::gmres(A, b, x, &jacobi, opts), opts);
+    x.reset();
+    expect_solved(A, b, x, Krylov::gmres(A, b, x, &ssor, opts), opts);
+
+    // ILU(0) must beat no preconditioning
+    vec x1, x2;
+    KrylovResult plain = Krylov::gmres(A, b, x1, nullptr, opts);
+    KrylovResult pre = Krylov::gmres(A, b, x2, &ilu, opts);
+    EXPECT_LT(pre.iterations, plain.iterations);
+}
+
+TEST(KrylovTests, ConjugateGradients) {
+    int m = 30;
+    sp_mat T(m, m);
+    for (int i = 0; i < m; ++i) {
+        T(i, i) = 2;
+        if (i > 0)
+            T(i, i - 1) = T(i - 1, i) = -1;
+    }
+    sp_mat I = speye(m, m);
+    sp_mat A = Utils::spkron(I, T) + Utils::spkron(T, I);
+    vec b = randu<vec>(A.n_rows);
+
+    KrylovOptions opts;
+    SSORPreconditioner ssor(A);
+    vec x;
+    KrylovResult res = Krylov::cg(A, b, x, &ssor, opts);
+    expect_solved(A, b, x, res, opts);
+
+    // Warm start from the solution
+    KrylovResult again = Krylov::cg(A, b, x, &ssor, opts);
+    EXPECT_TRUE(again.converged);
+    EXPECT_EQ(again.iterations, 0u);
+}
+
+TEST(KrylovTests, MatrixFree) {
+    int k = 4, m = 20;
+    Real dx = 1.0 / m;
+    Laplacian L(k, m, m, dx, dx);
+    sp_mat A = poisson(k, m, m);
+    sp_mat BC = A - L;
+
+    LinearOperator op = [&](const vec &x, vec &y) {
+        L.apply(x, y);
+        y += BC * x;
+    };
+
+    vec b = randu<vec>(A.n_rows);
+    KrylovOptions opts;
+    ILU0Preconditioner ilu(A);
+    vec x;
+    expect_solved(A, b, x, Krylov::bicgstab(op, b, x, &ilu, opts), opts);
+}
+
+TEST(KrylovTests, GMRESBreakdown) {
+    // b has a component in the null space, so the second Arnoldi column
+    // vanishes and no further progress is possible
+    sp_mat A(3, 3);
+    A(0, 0) = 1;
+    A(1, 1) = 1;
+    vec b = {1, 0, 1};
+    vec x;
+
+    KrylovResult res = Krylov::gmres(A, b, x);
+    EXPECT_FALSE(res.converged);
+    EXPECT_TRUE(x.is_finite());
+    EXPECT_NEAR(res.residual, 1.0, 1e-12);
+
+    // Nothing to build on from the first column
+    vec e = {0, 0, 1};
+    x.reset();
+    res = Krylov::gmres(A, e, x);
+    EXPECT_FALSE(res.converged);
+    EXPECT_TRUE(x.is_finite());
+}
+
+TEST(KrylovTests, MixedPrecision) {
+    sp_mat A = poisson(2, 20, 24);
+    vec b = randu<vec>(A.n_rows);
+    KrylovOptions opts;
+    opts.rtol = 1e-10;
+
+    // Float32 storage, float32 accuracy
+    fCSRMatrix Af(A);
+    fvec y = Af * conv_to<fvec>::from(b);
+    EXPECT_LT(norm(conv_to<vec>::from(y) - A * b), 1e-5 * norm(A * b));
+
+    // Refinement recovers float64 accuracy
+    ILU0Preconditioner ilu(A);
+    vec x;
+    KrylovResult res = Krylov::refine(A, b, x, KrylovMethod::GMRES, &ilu, opts);
+    EXPECT_TRUE(res.converged);
+    EXPECT_LE(norm(b - A * x), 1.01 * opts.rtol * norm(b));
+    EXPECT_GT(res.history.size(), 1u);
+
+    x.reset();
+    res = Krylov::refine(A, b, x, KrylovMethod::BiCGSTAB, nullptr, opts);
+    EXPECT_TRUE(res.converged);
+    EXPECT_LE(norm(b - A * x), 1.01 * opts.rtol * norm(b));
+}
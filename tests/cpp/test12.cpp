@@ -0,0 +1,56 @@
+#include "mole.h"
+#include <gtest/gtest.h>
+
+TEST(MultigridTests, Standalone2D) {
+    int k = 2, m = 64, n = 64;
+    Real dx = 1.0 / m, dy = 1.0 / n;
+    sp_mat A = Laplacian(k, m, n, dx, dy) + RobinBC(k, m, dx, n, dy, 1, 1);
+    vec b = randu<vec>(A.n_rows);
+
+    Multigrid mg(k, m, n, dx, dy, 1, 1);
+    EXPECT_GT(mg.levels(), 2);
+
+    vec x;
+    KrylovResult res = mg.solve(b, x);
+    EXPECT_TRUE(res.converged);
+    EXPECT_LE(res.iterations, 30);
+    EXPECT_LE(norm(b - A * x), 1.01e-8 * norm(b));
+}
+
+TEST(MultigridTests, Preconditioner) {
+    int k = 2, m = 64, n = 64;
+    Real dx = 1.0 / m, dy = 1.0 / n;
+    sp_mat A = Laplacian(k, m, n, dx, dy) + RobinBC(k, m, dx, n, dy, 1, 1);
+    vec b = randu<vec>(A.n_rows);
+
+    MultigridOptions mopts;
+    mopts.cycle = 2;
+    Multigrid mg(k, m, n, dx, dy, 1, 1, mopts);
+
+    KrylovOptions opts;
+    vec x1, x2;
+    KrylovResult plain = Krylov::gmres(A, b, x1, nullptr, opts);
+    KrylovResult pre = Krylov::gmres(A, b, x2, &mg, opts);
+    EXPECT_TRUE(pre.converged);
+    EXPECT_LE(pre.iterations, 20);
+    EXPECT_LT(pre.iterations, plain.iterations);
+}
+
+TEST(MultigridTests, OneAndThreeDimensions) {
+    int k = 2, m = 32;
+    Real dx = 1.0 / m;
+    sp_mat A1 = Laplacian(k, m, dx) + RobinBC(k, m, dx, 1, 1);
+    vec b1 = randu<vec>(A1.n_rows), x1;
+    Multigrid mg1(k, m, dx, 1, 1);
+    EXPECT_TRUE(mg1.solve(b1, x1).converged);
+    EXPECT_LE(norm(b1 - A1 * x1), 1.01e-8 * norm(b1));
+
+    m = 16;
+    dx = 1.0 / m;
+    sp_mat A3 = Laplacian(k, m, m, m, dx, dx, dx) +
+                RobinBC(k, m, dx, m, dx, m, dx, 1, 1);
+    vec b3 = randu<vec>(A3.n_rows), x3;
+    Multigrid mg3(k, m, m, m, dx, dx, dx, 1, 1);
+    EXPECT_TRUE(mg3.solve(b3, x3).converged);
+    EXPECT_LE(norm(b3 - A3 * x3), 1.01e-8 * norm(b3));
+}
@@ -0,0 +1,93 @@
+#include "mole.h"
+#include <gtest/gtest.h>
+#include <cmath>
+
+TEST(FastPoissonTests, Transforms) {
+    const Real pi = std::acos(-1.0);
+
+    // Powers of two take the radix-2 path, the rest Bluestein
+    for (uword n : {1, 6, 8, 13, 64}) {
+        FFT fft(n);
+        vec x = randu<vec>(n);
+
+        vec c = x, s = x;
+        fft.dct(c.memptr());
+        fft.dst(s.memptr());
+        for (uword k = 0; k < n; ++k) {
+            Real ck = 0, sk = 0;
+            for (uword j = 0; j < n; ++j) {
+                ck += x(j) * std::cos(pi * k * (2 * j + 1) / (2.0 * n));
+                sk += x(j) * std::sin(pi * (k + 1) * (2 * j + 1) / (2.0 * n));
+            }
+            EXPECT_NEAR(c(k), ck, 1e-10 * n);
+            EXPECT_NEAR(s(k), sk, 1e-10 * n);
+        }
+
+        fft.idct(c.memptr());
+        fft.idst(s.memptr());
+        EXPECT_LT(norm(c - x), 1e-12 * n);
+        EXPECT_LT(norm(s - x), 1e-12 * n);
+
+        std::vector<FFT::Complex> z(n), zz;
+        for (uword j = 0; j < n; ++j)
+            z[j] = FFT::Complex(x(j), 1.0 - x(j));
+        zz = z;
+        fft.forward(zz.data());
+        fft.inverse(zz.data());
+        for (uword j = 0; j < n; ++j)
+            EXPECT_NEAR(std::abs(zz[j] - z[j]), 0.0, 1e-12 * n);
+    }
+}
+
+TEST(FastPoissonTests, ExactNeumann) {
+    int k = 2, m = 30, n = 20, o = 12;
+    Real dx = 1.0 / m, dy = 2.0 / n, dz = 1.0 / o;
+
+    sp_mat A1 = Laplacian(k, m, dx) + RobinBC(k, m, dx, 0, 1);
+    sp_mat A2 = Laplacian(k, m, n, dx, dy) + RobinBC(k, m, dx, n, dy, 0, 1);
+    sp_mat A3 = Laplacian(k, m, n, o, dx, dy, dz) +
+                RobinBC(k, m, dx, n, dy, o, dz, 0, 1);
+
+    FastPoisson f1(k, m, dx, 0, 1);
+    FastPoisson f2(k, m, n, dx, dy, 0, 1);
+    FastPoisson f3(k, m, n, o, dx, dy, dz, 0, 1);
+    EXPECT_TRUE(f3.exact());
+
+    // Right-hand sides in the range of the singular operators
+    std::vector<std::pair<const sp_mat *, const FastPoisson *>> cases = {
+        {&A1, &f1}, {&A2, &f2}, {&A3, &f3}};
+    for (auto &c : cases) {
+        vec b = *c.first * randu<vec>(c.first->n_cols);
+        vec x;
+        EXPECT_TRUE(c.second->solve(b, x).converged);
+        EXPECT_LT(norm(*c.first * x - b), 1e-9 * norm(b));
+    }
+}
+
+TEST(FastPoissonTests, Preconditioner) {
+    int m = 40, n = 36;
+    Real dx = 1.0 / m, dy = 1.0 / n;
+    KrylovOptions opts;
+    opts.rtol = 1e-10;
+
+    // Dirichlet at second order, Neumann at fourth order
+    FastPoisson dirichlet(2, m, n, dx, dy, 1, 0);
+    FastPoisson neumann(4, m, n, dx, dy, 0, 1);
+    EXPECT_FALSE(dirichlet.exact());
+    EXPECT_FALSE(neumann.exact());
+
+    sp_mat A = Laplacian(2, m, n, dx, dy) + RobinBC(2, m, dx, n, dy, 1, 0);
+    vec b = randu<vec>(A.n_rows), x;
+    KrylovResult res = dirichlet.solve(b, x, opts);
+    EXPECT_TRUE(res.converged);
+    EXPECT_LE(res.iterations, 30);
+    EXPECT_LE(norm(b - A * x), 1.01e-10 * norm(b));
+
+    sp_mat B = Laplacian(4, m, n, dx, dy) + RobinBC(4, m, dx, n, dy, 0, 1);
+    vec c = B * randu<vec>(B.n_cols), y;
+    res = neumann.solve(c, y, opts);
+    EXPECT_TRUE(res.converged);
+    EXPECT_LE(res.iterations, 30);
+
+    EXPECT_THROW(FastPoisson(2, m, dx, 1, 1), std::invalid_argument);
+}
@@ -0,0 +1,59 @@
+#include "mole.h"
+#include <gtest/gtest.h>
+
+TEST(ExpressionTests, MatchesEagerEvaluation) {
+    int k = 2, m = 40;
+    Real dx = 1.0 / m, dt = 1e-3, dis = 0.7;
+
+    Gradient G(k, m, dx);
+    Divergence D(k, m, dx);
+    Interpol I(m, 0.5);
+
+    vec C = randu<vec>(m + 2);
+    vec V = randu<vec>(m + 1);
+
+    vec expected = C;
+    for (int i = 0; i < 5; ++i)
+        expected += dt * (D * (dis * (G * expected)) - D * (V % (I * expected)));
+
+    // In place, reusing the workspace every step
+    Workspace ws;
+    VecExpr c = lazy(C);
+    for (int i = 0; i < 5; ++i)
+        evaluate(c + dt * (D * (dis * (G * c)) - D * (lazy(V) % (I * c))), C, ws);
+
+    EXPECT_LT(norm(C - expected, "inf"), 1e-12);
+}
+
+TEST(ExpressionTests, NonlinearAndMultiDimensional) {
+    int k = 2, m = 12, n = 10;
+    Real dx = 0.1, dy = 0.2;
+
+    Laplacian L(k, m, n, dx, dy);
+    Divergence D(k, m, dx);
+    Interpol I(m, 1.0);
+
+    vec U = randu<vec>(L.n_cols), out;
+    Workspace ws;
+    evaluate(2.0 * (L * lazy(U)) - lazy(U), out, ws);
+    EXPECT_LT(norm(out - (2.0 * (L * U) - U), "inf"), 1e-9);
+
+    vec W = randu<vec>(m + 2);
+    vec expected = W - 0.05 * (D * (I * square(W)));
+    evaluate(lazy(W) - 0.05 * (D * (I * square(lazy(W)))), W, ws);
+    EXPECT_LT(norm(W - expected, "inf"), 1e-12);
+}
+
+TEST(ExpressionTests, LeafFollowsReallocation) {
+    vec U = randu<vec>(100);
+    VecExpr u = lazy(U);
+
+    // New memory after the leaf was built
+    U.reset();
+    U = randu<vec>(100);
+
+    vec out;
+    Workspace ws;
+    evaluate(2.0 * u, out, ws);
+    EXPECT_LT(norm(out - 2.0 * U, "inf"), 1e-15);
+}
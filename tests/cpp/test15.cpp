@@ -0,0 +1,62 @@
+#include "mole.h"
+#include <gtest/gtest.h>
+
+TEST(ComplexTests, Operators) {
+    int k = 4, m = 12, n = 13;
+    Real dx = 1.0 / m, dy = 1.0 / n;
+
+    cxLaplacian L(k, m, n, dx, dy);
+    EXPECT_LT(norm(sp_mat(real(L) - Laplacian(k, m, n, dx, dy)), "fro"),
+              1e-12);
+    EXPECT_EQ(norm(sp_mat(imag(L)), "fro"), 0.0);
+
+    cxRobinBC B(k, m, dx, n, dy, cx_double(1, 2), cx_double(0, 1));
+    EXPECT_LT(norm(sp_mat(real(B) - RobinBC(k, m, dx, n, dy, 1, 0)), "fro"),
+              1e-12);
+    EXPECT_LT(norm(sp_mat(imag(B) - RobinBC(k, m, dx, n, dy, 2, 1)), "fro"),
+              1e-12);
+}
+
+TEST(ComplexTests, CrankNicolson) {
+    int m = 40;
+    Real dx = 1.0 / m, dt = 0.01;
+
+    // Hermitian Hamiltonian
+    sp_mat T(m, m);
+    for (int i = 0; i < m; ++i) {
+        T(i, i) = 2 / (dx * dx);
+        if (i > 0)
+            T(i, i - 1) = T(i - 1, i) = -1 / (dx * dx);
+    }
+    cx_sp_mat H(0.5 * T, sp_mat(m, m));
+
+    cx_vec psi = randu<cx_vec>(m);
+    cx_vec psi0 = psi;
+
+    cx_sp_mat A = H + speye<cx_sp_mat>(m, m);
+    cxSparseSolver solver(A);
+    EXPECT_LT(norm(A * solver.solve(psi0) - psi0), 1e-10 * norm(psi0));
+
+    CrankNicolson cn(H, dt);
+    cn.step(psi, 3);
+
+    cx_mat I = eye<cx_mat>(m, m);
+    cx_mat S = solve(I + cx_double(0, 0.5 * dt) * cx_mat(H),
+                     I - cx_double(0, 0.5 * dt) * cx_mat(H));
+    cx_vec expected = S * (S * (S * psi0));
+
+    EXPECT_LT(norm(psi - expected), 1e-10 * norm(psi0));
+    EXPECT_NEAR(norm(psi), norm(psi0), 1e-10 * norm(psi0));
+
+    // Without a potential the split step is Crank-Nicolson
+    cx_vec phi = psi0;
+    SplitStep(H, zeros<vec>(m), dt).step(phi, 3);
+    EXPECT_LT(norm(phi - expected), 1e-10 * norm(psi0));
+
+    // Without kinetic energy it is a pointwise phase
+    vec V = linspace(0, 1, m);
+    phi = psi0;
+    SplitStep(cx_sp_mat(m, m), V, dt).step(phi, 2);
+    cx_vec phase = exp(cx_double(0, -2 * dt) * conv_to<cx_vec>::from(V));
+    EXPECT_LT(norm(phi - phase % psi0), 1e-12 * norm(psi0));
+}
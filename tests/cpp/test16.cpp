@@ -0,0 +1,60 @@
+#include "mole.h"
+#include <gtest/gtest.h>
+
+// Error at t = 1 of du/dt = -u, u(0) = 1, with n steps
+static Real decay_error(TimeScheme scheme, int n) {
+    TimeIntegrator rk(
+        scheme, [](Real, const vec &u, vec &dudt) { dudt = -u; }, 1);
+    vec u = {1.0};
+    Real t = rk.advance(u, 0.0, 1.0 / n, n);
+    EXPECT_NEAR(t, 1.0, 1e-12);
+    return std::abs(u(0) - std::exp(-1.0));
+}
+
+TEST(TimeIntegratorTests, ConvergenceOrder) {
+    const TimeScheme schemes[] = {TimeScheme::Euler, TimeScheme::SSPRK2,
+                                  TimeScheme::SSPRK3, TimeScheme::RK4};
+    const Real orders[] = {1, 2, 3, 4};
+
+    for (int s = 0; s < 4; ++s) {
+        Real e1 = decay_error(schemes[s], 20);
+        Real e2 = decay_error(schemes[s], 40);
+        EXPECT_NEAR(std::log2(e1 / e2), orders[s], 0.1);
+    }
+}
+
+TEST(TimeIntegratorTests, Operator) {
+    int m = 30;
+    Real dt = 1e-3;
+
+    sp_mat A = sprandu<sp_mat>(m, m, 0.2) - 0.5 * speye(m, m);
+    vec u0 = randu<vec>(m);
+
+    TimeIntegrator op(TimeScheme::RK4, A);
+    TimeIntegrator cb(
+        TimeScheme::RK4,
+        [&A](Real, const vec &u, vec &dudt) { dudt = A * u; }, m);
+
+    vec u = u0, w = u0;
+    op.advance(u, 0.0, dt, 50);
+    cb.advance(w, 0.0, dt, 50);
+    EXPECT_LT(norm(u - w), 1e-12 * norm(w));
+}
+
+TEST(TimeIntegratorTests, Verlet) {
+    // u'' = -u, u(0) = 1, u'(0) = 0
+    auto error = [](int n) {
+        Verlet leapfrog([](Real, const vec &u, vec &acc) { acc = -u; }, 1);
+        vec u = {1.0}, v = {0.0};
+        leapfrog.advance(u, v, 0.0, 1.0 / n, n);
+        return std::abs(u(0) - std::cos(1.0)) + std::abs(v(0) + std::sin(1.0));
+    };
+    EXPECT_NEAR(std::log2(error(20) / error(40)), 2.0, 0.1);
+
+    // Energy stays bounded over many periods
+    sp_mat A = -speye(2, 2);
+    Verlet oscillator(A);
+    vec u = {1.0, 0.0}, v = {0.0, 1.0};
+    oscillator.advance(u, v, 0.0, 0.05, 10000);
+    EXPECT_NEAR(dot(u, u) + dot(v, v), 2.0, 1e-2);
+}
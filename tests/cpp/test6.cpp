@@ -0,0 +1,174 @@
+#include "mole.h"
+#include <gtest/gtest.h>
+
+// Matrix-free applies must agree with the assembled operators
+template <typename Op>
+void expect_same_apply(const Op &A, Real tol) {
+    vec x = randu<vec>(A.n_cols);
+    vec y;
+    A.apply(x, y);
+    vec expected = static_cast<const sp_mat &>(A) * x;
+    EXPECT_LT(norm(y - expected, "inf"), tol * (1 + norm(expected, "inf")));
+}
+
+TEST(MatrixFreeTests, Gradient) {
+    Real tol = 1e-12;
+    for (int k : {2, 4, 6, 8}) {
+        int m = 2 * k + 3;
+        expect_same_apply(Gradient(k, m, 0.5), tol);
+        expect_same_apply(Gradient(k, m, m + 1, 0.5, 0.25), tol);
+        expect_same_apply(Gradient(k, m, m + 1, m + 2, 0.5, 0.25, 0.2), tol);
+    }
+}
+
+TEST(MatrixFreeTests, Divergence) {
+    Real tol = 1e-12;
+    for (int k : {2, 4, 6}) {
+        int m = 2 * k + 3;
+        expect_same_apply(Divergence(k, m, 0.5), tol);
+        expect_same_apply(Divergence(k, m, m + 1, 0.5, 0.25), tol);
+        expect_same_apply(Divergence(k, m, m + 1, m + 2, 0.5, 0.25, 0.2), tol);
+    }
+}
+
+TEST(MatrixFreeTests, Laplacian) {
+    Real tol = 1e-12;
+    for (int k : {2, 4, 6}) {
+        int m = 2 * k + 3;
+        expect_same_apply(Laplacian(k, m, 0.5), tol);
+        expect_same_apply(Laplacian(k, m, m + 1, 0.5, 0.25), tol);
+        expect_same_apply(Laplacian(k, m, m + 1, m + 2, 0.5, 0.25, 0.2), tol);
+    }
+}
+
+TEST(MatrixFreeTests, ModifiedOperatorFallsBack) {
+    int k = 4;
+    int m = 20;
+    Real dx = 1.0 / m;
+
+    Laplacian L(k, m, dx);
+    RobinBC BC(k, m, dx, 1, 1);
+    L = L + BC;
+
+    expect_same_apply(L, 1e-12);
+}
+
+TEST(MatrixFreeTests, ScaledOperatorFallsBack) {
+    int k = 4;
+    int m = 20;
+    Real dx = 1.0 / m;
+
+    // The sparsity pattern is unchanged, only the values
+    Laplacian L(k, m, m + 1, dx, dx);
+    L *= 0.5;
+    expect_same_apply(L, 1e-12);
+
+    Laplacian L2(k, m, dx);
+    L2 = -L2;
+    expect_same_apply(L2, 1e-12);
+    L2 = 2 * L2;
+    expect_same_apply(L2, 1e-12);
+
+    Gradient G(k, m, dx);
+    G /= 3.0;
+    expect_same_apply(G, 1e-12);
+
+    Divergence D(k, m, dx);
+    D += D;
+    expect_same_apply(D, 1e-12);
+}
+
+TEST(MatrixFreeTests, ElementWrites) {
+    int k = 4;
+    int m = 20;
+    Real dx = 1.0 / m;
+
+    // A new entry still in the element cache is seen by apply()
+    Laplacian L(k, m, dx);
+    L(0, 5) = 1.0;
+    expect_same_apply(L, 1e-12);
+
+    // Writes that keep the pattern need a reassignment, which drops the
+    // kernels
+    Laplacian L2(k, m, m + 1, dx, dx);
+    L2(30, 30) += 1.0;
+    L2.diag() += 2.0;
+    L2 = sp_mat(L2);
+    expect_same_apply(L2, 1e-12);
+}
+
+TEST(CSRMatrixTests, MatchesSparseProduct) {
+    int k = 4, m = 13;
+
+    // Uneven rows: dense boundary stencils plus BC terms
+    sp_mat A = Laplacian(k, m, m + 1, m + 2, 0.5, 0.25, 0.2) +
+               RobinBC(k, m, 0.5, m + 1, 0.25, m + 2, 0.2, 1, 1);
+    sp_mat I = Interpol(m, m + 1, 0.5, 0.5);
+
+    for (const sp_mat *B : {&A, &I}) {
+        CSRMatrix csr(*B);
+        vec x = randu<vec>(B->n_cols);
+        vec y;
+        csr.apply(x, y);
+        vec expected = *B * x;
+        EXPECT_LT(norm(y - expected, "inf"), 1e-12 * (1 + norm(expected, "inf")));
+        EXPECT_LT(norm(csr * x - expected, "inf"), 1e-12 * (1 + norm(expected, "inf")));
+    }
+}
+
+TEST(DIAMatrixTests, MatchesSparseProduct) {
+    int k = 4, m = 20;
+
+    sp_mat L = Laplacian(k, m, m + 1, m + 2, 0.5, 0.25, 0.2);
+    sp_mat A = L + RobinBC(k, m, 0.5, m + 1, 0.25, m + 2, 0.2, 1, 1);
+    std::vector<sp_mat> ops = {
+        A, Gradient(k, m, m + 1, m + 2, 0.5, 0.25, 0.2),
+        Divergence(k, m, m + 1, 0.5, 0.25), Interpol(m, m + 1, 0.5, 0.5),
+        Laplacian(k, 3 * m, 0.1)};
+
+    for (const sp_mat &B : ops) {
+        DIAMatrix dia(B);
+        vec x = randu<vec>(B.n_cols);
+        vec expected = B * x;
+        EXPECT_LT(norm(dia * x - expected, "inf"), 1e-12 * (1 + norm(expected, "inf")));
+    }
+
+    // Interior rows share their stencils, the patch holds the boundaries
+    DIAMatrix dia(L);
+    uword csc = L.n_nonzero * (sizeof(Real) + sizeof(uword)) +
+                (L.n_cols + 1) * sizeof(uword);
+    EXPECT_LT(3 * dia.memory(), csc);
+    EXPECT_LT(dia.patch_rows(), L.n_rows / 2);
+}
+
+// Operators assembled from the coefficient tables are exact for linear fields
+TEST(CoefficientTests, ExactOnLinearData) {
+    Real tol = 1e-10;
+    for (int k : {2, 4, 6}) {
+        int m = 2 * k + 3;
+        Real dx = 1.0 / m;
+
+        // Cell centers and boundaries, then faces
+        vec xc(m + 2);
+        xc(0) = 0.0;
+        xc.subvec(1, m) = regspace<vec>(0.5, 1.0, m - 0.5) * dx;
+        xc(m + 1) = 1.0;
+        vec xf = regspace<vec>(0, m) * dx;
+
+        Gradient G(k, m, dx);
+        vec g;
+        G.apply(xc, g);
+        EXPECT_LT(norm(g - 1.0, "inf"), tol);
+        EXPECT_EQ(G.getP().n_elem, 2u * k + 1);
+        EXPECT_EQ(norm(G.getP() - flipud(G.getP()), "inf"), 0.0);
+
+        Divergence D(k, m, dx);
+        vec d;
+        D.apply(xf, d);
+        EXPECT_EQ(d(0), 0.0);
+        EXPECT_EQ(d(m + 1), 0.0);
+        EXPECT_LT(norm(d.subvec(1, m) - 1.0, "inf"), tol);
+        EXPECT_EQ(D.getQ().n_elem, 2u * k + 1);
+        EXPECT_EQ(norm(D.getQ() - flipud(D.getQ()), "inf"), 0.0);
+    }
+}
@@ -0,0 +1,278 @@
+#include "mole.h"
+#include <gtest/gtest.h>
+
+// Direct assembly must reproduce the chained spkron/spjoin products
+void expect_same_matrix(const sp_mat &A, const sp_mat &B) {
+    ASSERT_EQ(A.n_rows, B.n_rows);
+    ASSERT_EQ(A.n_cols, B.n_cols);
+    EXPECT_EQ(A.n_nonzero, B.n_nonzero);
+    EXPECT_LT(norm(sp_mat(A - B), "fro"), 1e-12 * (1 + norm(B, "fro")));
+}
+
+TEST(KronAssemblyTests, Stacked) {
+    int k = 4, m = 11, n = 12, o = 13;
+    Gradient Gx(k, m, 1.0), Gy(k, n, 1.0), Gz(k, o, 1.0);
+
+    sp_mat Im = speye(m + 2, m + 2), In = speye(n + 2, n + 2),
+           Io = speye(o + 2, o + 2);
+    Im.shed_row(0);
+    Im.shed_row(m);
+    In.shed_row(0);
+    In.shed_row(n);
+    Io.shed_row(0);
+    Io.shed_row(o);
+
+    sp_mat G1 = Utils::spkron(Utils::spkron(Io, In), Gx);
+    sp_mat G2 = Utils::spkron(Utils::spkron(Io, Gy), Im);
+    sp_mat G3 = Utils::spkron(Utils::spkron(Gz, In), Im);
+
+    expect_same_matrix(Gradient(k, m, n, o, 1.0, 1.0, 1.0),
+                       Utils::spjoin_cols(Utils::spjoin_cols(G1, G2), G3));
+}
+
+TEST(KronAssemblyTests, Joined) {
+    int k = 4, m = 11, n = 12;
+    Divergence Dx(k, m, 1.0), Dy(k, n, 1.0);
+
+    sp_mat Im = speye(m + 2, m + 2), In = speye(n + 2, n + 2);
+    Im.shed_col(0);
+    Im.shed_col(m);
+    In.shed_col(0);
+    In.shed_col(n);
+
+    expect_same_matrix(Divergence(k, m, n, 1.0, 1.0),
+                       Utils::spjoin_rows(Utils::spkron(In, Dx),
+                                          Utils::spkron(Dy, Im)));
+}
+
+TEST(KronAssemblyTests, Summed) {
+    int k = 2, m = 6, n = 7;
+    RobinBC Bm(k, m, 1.0, 1.0, 2.0), Bn(k, n, 1.0, 1.0, 2.0);
+
+    sp_mat Im = speye(m + 2, m + 2), In = speye(n + 2, n + 2);
+    In.at(0, 0) = 0;
+    In.at(n + 1, n + 1) = 0;
+
+    expect_same_matrix(RobinBC(k, m, 1.0, n, 1.0, 1.0, 2.0),
+                       Utils::spkron(In, Bm) + Utils::spkron(Bn, Im));
+
+    // Overlapping terms are added and cancellations are dropped
+    sp_mat S = Utils::spkron_sum({KronTerm(In, Bm), KronTerm(In, -Bm)},
+                                 Bm.n_rows * In.n_rows, Bm.n_cols * In.n_cols);
+    EXPECT_EQ(S.n_nonzero, 0u);
+}
+
+TEST(KronAssemblyTests, LazyOperator) {
+    int k = 4, m = 11, n = 12, o = 13;
+    Real dx = 0.5, dy = 0.25, dz = 0.2;
+
+    std::vector<std::pair<KronOperator, sp_mat>> cases = {
+        {KronOperator::gradient(k, m, n, dx, dy), Gradient(k, m, n, dx, dy)},
+        {KronOperator::gradient(k, m, n, o, dx, dy, dz),
+         Gradient(k, m, n, o, dx, dy, dz)},
+        {KronOperator::divergence(k, m, n, dx, dy), Divergence(k, m, n, dx, dy)},
+        {KronOperator::divergence(k, m, n, o, dx, dy, dz),
+         Divergence(k, m, n, o, dx, dy, dz)},
+        {KronOperator::laplacian(k, m, n, dx, dy), Laplacian(k, m, n, dx, dy)},
+        {KronOperator::laplacian(k, m, n, o, dx, dy, dz),
+         Laplacian(k, m, n, o, dx, dy, dz)}};
+
+    for (auto &c : cases) {
+        const KronOperator &K = c.first;
+        const sp_mat &A = c.second;
+        ASSERT_EQ(K.n_rows, A.n_rows);
+        ASSERT_EQ(K.n_cols, A.n_cols);
+
+        vec x = randu<vec>(A.n_cols);
+        vec expected = A * x;
+        EXPECT_LT(norm(K * x - expected, "inf"), 1e-10 * (1 + norm(expected, "inf")));
+        EXPECT_LT(norm(sp_mat(K.assemble() - A), "fro"), 1e-10 * (1 + norm(A, "fro")));
+        EXPECT_LT(K.memory(), A.n_nonzero * sizeof(Real));
+    }
+
+    // Slabs longer than one cache block, applied twice with the same
+    // workspace
+    KronOperator K = KronOperator::laplacian(k, 30, 31, 32, dx, dy, dz);
+    Laplacian A(k, 30, 31, 32, dx, dy, dz);
+    vec y;
+    for (int i = 0; i < 2; ++i) {
+        vec x = randu<vec>(A.n_cols);
+        K.apply(x, y);
+        vec expected = A * x;
+        EXPECT_LT(norm(y - expected, "inf"), 1e-10 * (1 + norm(expected, "inf")));
+    }
+}
+
+TEST(KronAssemblyTests, FusedLaplacian) {
+    Real dx = 0.5, dy = 0.25, dz = 0.2;
+    for (int k : {2, 4, 6}) {
+        int m = 2 * k + 3, n = m + 1, o = m + 2;
+        expect_same_matrix(Laplacian(k, m, n, dx, dy),
+                           Divergence(k, m, n, dx, dy) * Gradient(k, m, n, dx, dy));
+        expect_same_matrix(Laplacian(k, m, n, o, dx, dy, dz),
+                           Divergence(k, m, n, o, dx, dy, dz) *
+                               Gradient(k, m, n, o, dx, dy, dz));
+    }
+}
+
+TEST(BoundaryPatchTests, MergedRows) {
+    Real dx = 0.5, dy = 0.25, dz = 0.2;
+    for (int k : {2, 4}) {
+        int m = 2 * k + 3, n = m + 1, o = m + 2;
+
+        // 3-D constructor against the explicit Kronecker products
+        RobinBC Bm(k, m, dx, 1.0, 2.0), Bn(k, n, dy, 1.0, 2.0),
+            Bo(k, o, dz, 1.0, 2.0);
+        sp_mat Im = speye(m + 2, m + 2), In = speye(n + 2, n + 2),
+               Io = speye(o + 2, o + 2);
+        sp_mat In0 = In, Io0 = Io;
+        In0.at(0, 0) = 0;
+        In0.at(n + 1, n + 1) = 0;
+        Io0.at(0, 0) = 0;
+        Io0.at(o + 1, o + 1) = 0;
+        expect_same_matrix(
+            RobinBC(k, m, dx, n, dy, o, dz, 1.0, 2.0),
+            Utils::spkron(Utils::spkron(Io0, In0), Bm) +
+                Utils::spkron(Utils::spkron(Io0, Bn), Im) +
+                Utils::spkron(Utils::spkron(Bo, In), Im));
+
+        // Merged into the boundary rows of an existing operator
+        sp_mat L3 = Laplacian(k, m, n, o, dx, dy, dz);
+        BoundaryPatch P3 = BoundaryPatch::robin(k, m, dx, n, dy, o, dz, 1.0, 2.0);
+        P3.add_to(L3);
+        expect_same_matrix(L3, Laplacian(k, m, n, o, dx, dy, dz) +
+                                   RobinBC(k, m, dx, n, dy, o, dz, 1.0, 2.0));
+        EXPECT_EQ(P3.rows(), (uword)(2 * ((n * o) + (m + 2) * o +
+                                          (m + 2) * (n + 2))));
+
+        std::vector<Real> dirichlet = {1.0}, neumann = {2.0},
+                          robin = {1.0, 2.0};
+        MixedBC Mm(k, m, dx, "Dirichlet", dirichlet, "Neumann", neumann);
+        MixedBC Mn(k, n, dy, "Robin", robin, "Dirichlet", dirichlet);
+        sp_mat L2 = Laplacian(k, m, n, dx, dy);
+        BoundaryPatch(Mm, Mn).add_to(L2);
+        expect_same_matrix(L2, Laplacian(k, m, n, dx, dy) +
+                                   MixedBC(k, m, dx, n, dy, "Dirichlet",
+                                           dirichlet, "Neumann", neumann,
+                                           "Robin", robin, "Dirichlet",
+                                           dirichlet));
+
+        // Existing entries are summed
+        sp_mat B1 = RobinBC(k, m, dx, 1.0, 2.0);
+        BoundaryPatch(RobinBC(k, m, dx, 1.0, 2.0)).add_to(B1);
+        expect_same_matrix(B1, 2.0 * RobinBC(k, m, dx, 1.0, 2.0));
+
+        // Into an empty matrix, and into a pattern that already has them
+        sp_mat Z(m + 2, m + 2);
+        BoundaryPatch::robin(k, m, dx, 1.0, 2.0).add_to(Z);
+        expect_same_matrix(Z, RobinBC(k, m, dx, 1.0, 2.0));
+        BoundaryPatch::robin(k, m, dx, n, dy, 1.0, 2.0).add_to(L2);
+        expect_same_matrix(L2, Laplacian(k, m, n, dx, dy) +
+                                   MixedBC(k, m, dx, n, dy, "Dirichlet",
+                                           dirichlet, "Neumann", neumann,
+                                           "Robin", robin, "Dirichlet",
+                                           dirichlet) +
+                                   RobinBC(k, m, dx, n, dy, 1.0, 2.0));
+    }
+}
+
+TEST(MixedBCTests, Descriptors) {
+    Real dx = 0.1;
+    for (int k : {2, 4, 6, 8}) {
+        int m = 2 * k + 1;
+
+        // Boundary rows taken from an assembled gradient
+        mat G(Gradient(k, m, dx));
+        mat ref(m + 2, m + 2, fill::zeros);
+        for (int j = 0; j < m + 2; ++j) {
+            ref(0, j) = -3.0 * G(0, j);
+            ref(m + 1, j) = 0.5 * G(m, j);
+        }
+        ref(0, 0) += 2.0;
+
+        MixedBC B(k, m, dx, FaceBC::robin(2, 3), FaceBC::neumann(0.5));
+        EXPECT_LT(norm(mat(B) - ref, "inf"), 1e-12 * norm(ref, "inf"));
+
+        std::vector<Real> robin = {2, 3}, neumann = {0.5};
+        expect_same_matrix(MixedBC(k, m, dx, "Robin", robin, "Neumann", neumann),
+                           B);
+    }
+
+    int k = 4, m = 9, n = 10, o = 11;
+    std::vector<Real> one = {1}, two = {1, 2};
+    expect_same_matrix(
+        MixedBC(k, m, 1.0, n, 1.0, o, 1.0, FaceBC::dirichlet(1),
+                FaceBC::neumann(1), FaceBC::robin(1, 2), FaceBC::dirichlet(1),
+                FaceBC::neumann(1), FaceBC::robin(1, 2)),
+        MixedBC(k, m, 1.0, n, 1.0, o, 1.0, "Dirichlet", one, "Neumann", one,
+                "Robin", two, "Dirichlet", one, "Neumann", one, "Robin", two));
+    expect_same_matrix(RobinBC(k, m, 1.0, 1, 2),
+                       MixedBC(k, m, 1.0, FaceBC::robin(1, 2),
+                               FaceBC::robin(1, 2)));
+
+    EXPECT_THROW(FaceBC::parse("Periodic", one), std::invalid_argument);
+    EXPECT_THROW(FaceBC::parse("Robin", one), std::invalid_argument);
+}
+
+TEST(KronAssemblyTests, SpkronMatchesDense) {
+    arma_rng::set_seed(7);
+    sp_mat A = sprandu<sp_mat>(9, 7, 0.3);
+    sp_mat B = sprandu<sp_mat>(5, 6, 0.4);
+    B.col(2).zeros();
+
+    sp_mat K = Utils::spkron(A, B);
+    EXPECT_EQ(K.n_nonzero, A.n_nonzero * B.n_nonzero);
+    expect_same_matrix(K, sp_mat(kron(mat(A), mat(B))));
+
+    expect_same_matrix(Utils::spkron(sp_mat(3, 4), B), sp_mat(15, 24));
+}
+
+TEST(KronAssemblyTests, JoinedBlocks) {
+    arma_rng::set_seed(11);
+    sp_mat A = sprandu<sp_mat>(6, 5, 0.4);
+    sp_mat B = sprandu<sp_mat>(6, 3, 0.4);
+    sp_mat C = sprandu<sp_mat>(4, 5, 0.4);
+    sp_mat D = sprandu<sp_mat>(2, 5, 0.4);
+
+    expect_same_matrix(Utils::spjoin_rows(A, B), join_rows(A, B));
+    expect_same_matrix(Utils::spjoin_cols(A, C), join_cols(A, C));
+    expect_same_matrix(Utils::spjoin_rows({&A, &B, &A}),
+                       join_rows(join_rows(A, B), A));
+    expect_same_matrix(Utils::spjoin_cols({&A, &C, &D}),
+                       join_cols(join_cols(A, C), D));
+}
+
+TEST(TripletsTests, MatchesDenseAccumulation) {
+    arma_rng::set_seed(3);
+    const uword r = 9, c = 7;
+    mat ref(r, c, fill::zeros);
+    Triplets t(r, c, 4);
+
+    // Unordered entries, many at the same locations, past the capacity
+    for (int p = 0; p < 200; ++p) {
+        const uword i = (5 * p + p / 11) % r;
+        const uword j = (3 * p + p / 13) % c;
+        const Real v = randu() - 0.5;
+        t.at(i, j) = v;
+        ref(i, j) += v;
+    }
+
+    // Explicit zeros and entries that cancel are dropped
+    t.at(0, 0) = 0.0;
+    t.at(r - 1, c - 1) = 1.5;
+    t.at(r - 1, c - 1) = -1.5 - ref(r - 1, c - 1);
+    ref(r - 1, c - 1) = 0.0;
+
+    sp_mat A = t.assemble(2.0);
+    EXPECT_EQ(A.n_rows, r);
+    EXPECT_EQ(A.n_cols, c);
+    EXPECT_EQ(A.n_nonzero, (uword)accu(ref != 0.0));
+    EXPECT_LT(norm(mat(A) - 2.0 * ref, "inf"), 1e-12);
+
+    A.sync();
+    for (uword j = 0; j < c; ++j)
+        for (uword p = A.col_ptrs[j] + 1; p < A.col_ptrs[j + 1]; ++p)
+            EXPECT_LT(A.row_indices[p - 1], A.row_indices[p]);
+
+    EXPECT_EQ(Triplets(r, c).assemble().n_nonzero, 0u);
+}
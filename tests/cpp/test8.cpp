@@ -0,0 +1,37 @@
+#include "mole.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+TEST(OperatorCacheTests, SharesOperators) {
+    OperatorCache cache;
+    auto L1 = cache.get<Laplacian>(4, 20, 0.05);
+    auto L2 = cache.get<Laplacian>(4, 20, 0.05);
+    auto L3 = cache.get<Laplacian>(4, 20, 0.1);
+    auto G = cache.get<Gradient>(4, 20, 0.05);
+
+    EXPECT_EQ(L1.get(), L2.get());
+    EXPECT_NE(L1.get(), L3.get());
+    EXPECT_EQ(cache.hits(), 1u);
+    EXPECT_EQ(cache.misses(), 3u);
+    EXPECT_EQ(cache.size(), 3u);
+    EXPECT_EQ(G->n_rows, 21u);
+    EXPECT_EQ(norm(sp_mat(*L1 - Laplacian(4, 20, 0.05)), "fro"), 0.0);
+}
+
+TEST(OperatorCacheTests, BuildsOnceUnderContention) {
+    OperatorCache cache;
+    std::vector<std::shared_ptr<const Divergence>> ops(8);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < 8; ++t)
+        threads.emplace_back([&cache, &ops, t] {
+            ops[t] = cache.get<Divergence>(2, 10, 12, 14, 0.1, 0.1, 0.1);
+        });
+    for (std::thread &t : threads)
+        t.join();
+
+    for (int t = 1; t < 8; ++t)
+        EXPECT_EQ(ops[t].get(), ops[0].get());
+    EXPECT_EQ(cache.misses(), 1u);
+    EXPECT_EQ(cache.hits(), 7u);
+}
@@ -0,0 +1,90 @@
+#include "mole.h"
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+
+TEST(OperatorStoreTests, RoundTrip) {
+    const int k = 4, m = 10, n = 11, o = 12;
+    Real dx = 0.1, dy = 0.2, dz = 0.3;
+    sp_mat A = Laplacian(k, m, n, o, dx, dy, dz) +
+               RobinBC(k, m, dx, n, dy, o, dz, 1, 1);
+    std::string path = testing::TempDir() + "mole_store_test.bin";
+
+    OperatorStore::save(path, A, "Laplacian+RobinBC", {k, m, n, o, dx, dy, dz});
+    MappedOperator B(path);
+
+    EXPECT_TRUE(B.matches("Laplacian+RobinBC", {k, m, n, o, dx, dy, dz}));
+    EXPECT_FALSE(B.matches("Laplacian+RobinBC", {k, m, n, o, dx, dy, 0.4}));
+    EXPECT_FALSE(B.matches("Laplacian", {k, m, n, o, dx, dy, dz}));
+
+    EXPECT_EQ(norm(sp_mat(A - B.to_sp_mat()), "fro"), 0.0);
+
+    vec x = randu<vec>(A.n_cols);
+    vec y;
+    B.apply(x, y);
+    EXPECT_LT(norm(y - A * x, "inf"), 1e-12 * norm(A * x, "inf"));
+
+    std::remove(path.c_str());
+}
+
+TEST(OperatorStoreTests, RejectsOtherFiles) {
+    std::string path = testing::TempDir() + "mole_store_bad.bin";
+    FILE *f = fopen(path.c_str(), "wb");
+    std::vector<char> junk(512, 'x');
+    fwrite(junk.data(), 1, junk.size(), f);
+    fclose(f);
+
+    EXPECT_THROW(MappedOperator bad(path), std::runtime_error);
+
+    std::remove(path.c_str());
+}
+
+TEST(OperatorStoreTests, RejectsCorruptArrays) {
+    const int k = 2, m = 8;
+    sp_mat A = Laplacian(k, m, 1.0 / m);
+    std::string path = testing::TempDir() + "mole_store_corrupt.bin";
+
+    // Overwrites one 8-byte word of a valid file
+    auto patch = [&](size_t offset, u64 word) {
+        OperatorStore::save(path, A, "Laplacian", {k, m});
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(offset);
+        f.write(reinterpret_cast<const char *>(&word), sizeof(word));
+    };
+    const size_t header = sizeof(OperatorHeader);
+    const size_t row_indices = header + (A.n_cols + 1) * sizeof(u64);
+
+    // Row index past the last row
+    patch(row_indices, A.n_rows);
+    EXPECT_THROW(MappedOperator bad(path), std::runtime_error);
+
+    // Column pointers that decrease
+    patch(header + sizeof(u64), A.n_nonzero + 1);
+    EXPECT_THROW(MappedOperator bad(path), std::runtime_error);
+
+    // Sizes whose byte count overflows
+    patch(offsetof(OperatorHeader, n_nonzero), u64(1) << 62);
+    EXPECT_THROW(MappedOperator bad(path), std::runtime_error);
+
+    std::remove(path.c_str());
+}
+
+TEST(OperatorStoreTests, KrylovSolve) {
+    const int k = 4, m = 20;
+    Real dx = 1.0 / m;
+    sp_mat A = Laplacian(k, m, m, dx, dx) + RobinBC(k, m, dx, m, dx, 1, 1);
+    std::string path = testing::TempDir() + "mole_store_solve.bin";
+
+    OperatorStore::save(path, A, "Laplacian+RobinBC", {k, m, m, dx, dx});
+    MappedOperator B(path);
+
+    vec b = randu<vec>(A.n_rows);
+    vec x;
+    ILU0Preconditioner ilu(A);
+    KrylovResult result = Krylov::bicgstab(B.linear_operator(), b, x, &ilu);
+    EXPECT_TRUE(result.converged);
+    EXPECT_LT(norm(A * x - b), 1e-7 * norm(b));
+
+    std::remove(path.c_str());
+}